@@ -0,0 +1,136 @@
+/*!
+ Self-check of the set kernels (SetKernels.h), run by "make check". Every kernel level
+ the cpu supports is selected in turn and the results of SortedIntersect,
+ SortedDifference, SortedIntersectCount, SortedUnion and BitAndCount on random inputs
+ are compared with std::set_intersection, std::set_difference, std::set_union and a
+ plain popcount loop. The inputs cover empty sets, sets of every size around the
+ block widths of the kernels, sparse and dense overlaps and the size ratios that
+ switch to galloping. Prints the first mismatch and exits with 1 if there is one.
+
+ \sa SetKernels.h
+ */
+
+#include "../headers/SetKernels.h"
+#include <random>
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+//! number of random input pairs per kernel level
+static const int NUM_TRIALS=20000;
+
+//! sorted array of n distinct elements drawn from [0,universe)
+static void RandomSet(mt19937 &gen, int n, unsigned int universe, vector<unsigned int> &v){
+    v.clear();
+    if (n > universe) n = universe;
+    if (universe <= 4*(unsigned int)n){
+        //dense, take n elements of a shuffled universe
+        for(unsigned int x=0; x < universe; x++) v.push_back(x);
+        shuffle(v.begin(),v.end(),gen);
+        v.resize(n);
+    }else{
+        //sparse, duplicates are rare
+        uniform_int_distribution<unsigned int> draw(0,universe-1);
+        while (v.size() < n){
+            while (v.size() < n) v.push_back(draw(gen));
+            sort(v.begin(),v.end());
+            v.erase(unique(v.begin(),v.end()),v.end());
+        }
+    }
+    sort(v.begin(),v.end());
+}
+
+//! a size up to 300, small sizes and sizes near multiples of 16 more often
+static int RandomSize(mt19937 &gen){
+    switch (gen() % 4){
+        case 0: return gen() % 20;
+        case 1: return 16*(1 + gen() % 8) + (int)(gen() % 5) - 2;
+        default: return gen() % 300;
+    }
+}
+
+static void Report(const char *op, int level, const vector<unsigned int> &a, const vector<unsigned int> &b){
+    cout<<"\nMISMATCH "<<op<<" at level "<<KernelLevelName(level)<<" |a|="<<a.size()<<" |b|="<<b.size()<<endl;
+}
+
+//! compares all sorted array kernels on a and b, returns false at the first mismatch
+static bool CheckPair(int level, const vector<unsigned int> &a, const vector<unsigned int> &b){
+    const unsigned int *pa = a.empty() ? NULL : &a[0];
+    const unsigned int *pb = b.empty() ? NULL : &b[0];
+    int na = a.size(), nb = b.size();
+    vector<unsigned int> expected;
+    vector<unsigned int> out(na + nb + KERNEL_SLACK);
+
+    set_intersection(a.begin(),a.end(),b.begin(),b.end(),back_inserter(expected));
+    int k = SortedIntersect(pa,na,pb,nb,&out[0]);
+    if (k != expected.size() || !equal(expected.begin(),expected.end(),out.begin())){
+        Report("SortedIntersect",level,a,b);
+        return false;
+    }
+    if (SortedIntersectCount(pa,na,pb,nb) != expected.size()){
+        Report("SortedIntersectCount",level,a,b);
+        return false;
+    }
+
+    expected.clear();
+    set_difference(a.begin(),a.end(),b.begin(),b.end(),back_inserter(expected));
+    k = SortedDifference(pa,na,pb,nb,&out[0]);
+    if (k != expected.size() || !equal(expected.begin(),expected.end(),out.begin())){
+        Report("SortedDifference",level,a,b);
+        return false;
+    }
+
+    expected.clear();
+    set_union(a.begin(),a.end(),b.begin(),b.end(),back_inserter(expected));
+    k = SortedUnion(pa,na,pb,nb,&out[0]);
+    if (k != expected.size() || !equal(expected.begin(),expected.end(),out.begin())){
+        Report("SortedUnion",level,a,b);
+        return false;
+    }
+    return true;
+}
+
+//! compares BitAndCount on random bitmaps of every length up to 40 words
+static bool CheckBits(int level, mt19937 &gen){
+    for(int nwords=0; nwords <= 40; nwords++){
+        vector<unsigned long long> a(nwords), b(nwords);
+        for(int i=0; i < nwords; i++){
+            a[i] = ((unsigned long long)gen() << 32) | gen();
+            b[i] = ((unsigned long long)gen() << 32) | gen();
+        }
+        int expected = 0;
+        for(int i=0; i < nwords; i++) expected += __builtin_popcountll(a[i] & b[i]);
+        if (BitAndCount(a.empty() ? NULL : &a[0], b.empty() ? NULL : &b[0], nwords) != expected){
+            cout<<"\nMISMATCH BitAndCount at level "<<KernelLevelName(level)<<" nwords="<<nwords<<endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv){
+    int maxLevel = DetectKernelLevel();
+    for(int level=KERNEL_SCALAR; level <= maxLevel; level++){
+        SetKernelLevel(level);
+        mt19937 gen(12345);
+        vector<unsigned int> a, b;
+        for(int t=0; t < NUM_TRIALS; t++){
+            int na = RandomSize(gen);
+            int nb = RandomSize(gen);
+            //one input much larger than the other, for the galloping kernels
+            if (t % 10 == 0) nb = na*40 + gen() % 100;
+            //a small universe gives dense overlaps, a large one sparse overlaps
+            unsigned int universe = (t % 3 == 0) ? (na + nb) + 1 : (t % 3 == 1) ? 2*(na + nb) + 1 : 1000000;
+            RandomSet(gen,na,universe,a);
+            RandomSet(gen,nb,universe,b);
+            if (!CheckPair(level,a,b) || !CheckPair(level,b,a) || !CheckPair(level,a,a))
+                return 1;
+        }
+        if (!CheckBits(level,gen))
+            return 1;
+        cout<<"\n"<<KernelLevelName(level)<<": ok";
+    }
+    cout<<endl;
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*!
+ Self-check of the frequency weights of NClusterRandomSample, run by "make check".
+ Builds a star HIN with central domain 1 and two contexts (1,2) and (1,3), in which the
+ objects of domain 1 have increasing degrees, and checks that GetFreqWeightsStar gives
+ higher degree objects larger normalized weights, that the weights sum to 1 and that
+ an object without neighbors in one context gets the smallest weight.
+ Prints the first failure and exits with 1 if there is one.
+
+ \sa random_sample.h
+ */
+
+#include "../headers/random_sample.h"
+#include <cmath>
+
+using namespace std;
+
+//! number of objects in each domain
+static const int NUM_OBJS=6;
+
+//! context between domain 1 and domain t in which object i of domain 1 is related to degree[i] objects of t
+static Context *MakeStarContext(int t, const int *degree, int ctxId){
+    NCluster *rows = new NCluster(NUM_OBJS);
+    NCluster *cols = new NCluster(NUM_OBJS);
+    for(int i=0; i < NUM_OBJS; i++){
+        for(int j=0; j < degree[i]; j++){
+            rows->GetSet(i)->Add(j);
+            cols->GetSet(j)->Add(i);
+        }
+    }
+    Context *c = new Context(rows,cols);
+    c->SetDomainId(0,1);
+    c->SetDomainId(1,t);
+    c->SetId(ctxId);
+    return c;
+}
+
+static int Fail(const char *msg){
+    cout<<"\nFAILED "<<msg<<endl;
+    return 1;
+}
+
+int main(int argc, char **argv){
+    //object 0 has no neighbors in the second context, the others have increasing degrees
+    int degree2[NUM_OBJS] = {1,1,2,3,4,6};
+    int degree3[NUM_OBJS] = {0,1,2,3,5,6};
+    RelationGraph *g = new RelationGraph;
+    g->AddContext(MakeStarContext(2,degree2,0));
+    g->AddContext(MakeStarContext(3,degree3,1));
+
+    NClusterRandomSample sampler;
+    vector<long double> *w = sampler.GetFreqWeightsStar(g,1);
+    if (w->size() != NUM_OBJS)
+        return Fail("one weight per object of the central domain");
+    long double sum = 0;
+    for(int i=0; i < w->size(); i++) sum += (*w)[i];
+    if (fabsl(sum - 1) > 1e-9)
+        return Fail("weights sum to 1");
+    for(int i=2; i < NUM_OBJS; i++){
+        if (!((*w)[i] > (*w)[i-1]))
+            return Fail("higher degree objects get larger weights");
+    }
+    //average degree 1 against 6, the weights are powers of 2 of the averages
+    if (fabsl((*w)[NUM_OBJS-1]/(*w)[1] - powl(2,5)) > 1e-6)
+        return Fail("weights are 2^(average degree)");
+    for(int i=1; i < NUM_OBJS; i++){
+        if (!((*w)[0] < (*w)[i]))
+            return Fail("an object without neighbors in a context gets the smallest weight");
+    }
+    delete w;
+    cout<<"\nGetFreqWeightsStar: ok"<<endl;
+    return 0;
+}
@@ -23,6 +23,10 @@ float simMatTime;
 //! framework object to implement algorithm
 Ghin framework;
 string inputFile="~";
+//! write the run statistics to the file stats
+bool writeStats=false;
+//! keep only the top K clusters while running
+bool topKMode=false;
 
 
 using namespace std;
@@ -33,10 +37,22 @@ void DisplayUsage(){
         <<"\nREQUIRED: "
         <<"\n-i <inputFile>"
         <<"\n-w <weight of zeros>"
-        <<"\n-reward 1- simple weighted 2- Hypogeometric expected satisfaction"
+        <<"\n-reward 1- simple weighted 2- Hypogeometric expected satisfaction 3- Beta-binomial expected satisfaction"
         <<"\nOPTIONAL (use in this order):  "
         <<"\n-tiring (use tiring party goers mode)"
         <<"\n-prog display progress"
+        <<"\n-dense use bit-matrix contexts everywhere, implies -direct (-direct alone: only contexts with density > 0.1)"
+        <<"\n-direct recount overlaps at every reward evaluation instead of keeping incremental counters"
+        <<"\n-threads <n> run deals in n threads (default 1)"
+        <<"\n-pipeline draw seeds ahead of the deal threads in a separate sampler thread"
+        <<"\n-dealthreads <n> score the objects of a deal step in n threads (default 1)"
+        <<"\n-jacobi update all domains of a deal simultaneously in every round"
+        <<"\n-seed <n> seed of the random choices (default: the clock)"
+        <<"\n-ovlp <t> keep only the better of two clusters that overlap by more than t"
+        <<"\n-topk <k> keep only the k best clusters while running"
+        <<"\n-quality 1- area 2- beta area 3- total reward, ranks the clusters with -topk and -ovlp (default 1)"
+        <<"\n-beta <b> beta of the beta area, 0 < b < 1 (default 0.5)"
+        <<"\n-stats write run statistics to the file stats"
         <<"\n-o <filename> output final clusters"
         <<"\n\tthese will be output to filename.clusters and filenames.clusters.names"
         <<"\n\n";
@@ -53,35 +69,57 @@ void CheckArguments(){
         cout<<"\nw value is not set!";
         DisplayUsage();
     }
-    if( framework.rewardMode < 1 || framework.rewardMode >= 3){
+    if(framework.numThreads < 1 || framework.dealThreads < 1){
+        cout<<"\nInvalid number of threads!";
+        DisplayUsage();
+    }
+    if( !framework.SetRewardMode(framework.rewardMode)){
         cout<<"\nInvalid reward mode!";
         DisplayUsage();
     }
+    if(framework.qualityMode < framework.AREA || framework.qualityMode > framework.TOTAL_REWARD){
+        cout<<"\nInvalid quality mode!";
+        DisplayUsage();
+    }
     //now check operation modes
-    if(framework.enumerationMode == framework.ENUM_FILE && framework.OUTFILE != "~"){
+    if(topKMode)
+        framework.enumerationMode = framework.enumerationMode == framework.ENUM_FILE ? framework.ENUM_TOPK_FILE : framework.ENUM_TOPK_MEM;
+    if((framework.enumerationMode == framework.ENUM_FILE || framework.enumerationMode == framework.ENUM_TOPK_FILE) && framework.OUTFILE != "~"){
         cout<<"\nOutput clusters option enabled: "<<framework.OUTFILE;
         string file1 = framework.OUTFILE+".concepts";
         string file2 = framework.OUTFILE+".concepts.names";
         framework.OUT1.open(file1.c_str());
         framework.OUT2.open(file2.c_str());
     }
-    else if( framework.enumerationMode == framework.ENUM_FILE && framework.OUTFILE == "~"){
+    else if( (framework.enumerationMode == framework.ENUM_FILE || framework.enumerationMode == framework.ENUM_TOPK_FILE) && framework.OUTFILE == "~"){
         cout<<"\nOutput option enabled but file not specified!";
         DisplayUsage();
     }
     if(framework.dispProgress)
         cout<<"\nDisplay progress option enabled";
     
-    if (framework.rewardMode == framework.SIMPLE_WEIGHTED){
-         cout<<"\nReward function is: SIMPLE WEIGHTED with w= "<<framework.w;
-         framework.RewardFunc = &Simple_Weighted_Score;
-
-     }else if(framework.rewardMode == framework.EXPECTED_HYPGEO_SAT){
-             cout<<"\nReward function is: HYPO-GEOMETRIC EXPECTED SATISFACTION with w= "<<framework.w;
-              framework.RewardFunc = &Exp_Sat_HypGeo_Score;
-     }
+    cout<<"\nReward function is: "<<framework.reward->name<<" with w= "<<framework.w;
      if(framework.tiredMode == true)
          cout<<"\nTiring mode enabled";
+     if(framework.denseMode == true)
+         cout<<"\nDense context mode enabled";
+     if(framework.directMode == true)
+         cout<<"\nDirect overlap counting enabled";
+     if(framework.numThreads > 1)
+         cout<<"\nRunning deals in "<<framework.numThreads<<" threads";
+     if(framework.numThreads > 1 && framework.pipelineMode == true)
+         cout<<"\nPipelined seed sampling enabled";
+     if(framework.jacobiMode == true)
+         cout<<"\nSimultaneous best responses enabled";
+     if(framework.dealThreads > 1)
+         cout<<"\nScoring deal steps in "<<framework.dealThreads<<" threads";
+     if(topKMode)
+         cout<<"\nKeeping the top "<<framework.topKK<<" clusters";
+     if(framework.distinctMode == true)
+         cout<<"\nDropping clusters that overlap by more than "<<framework.ovlpThresh;
+     if(framework.seed >= 0)
+         cout<<"\nRandom seed: "<<framework.seed;
+     cout<<"\nSet kernels: "<<KernelLevelName(GetKernelLevel());
     
 
 
@@ -108,6 +146,46 @@ void ProcessCmndLine(int argc, char ** argv){
            else if(temp == "-tiring"){
                framework.tiredMode=true;
            }
+           else if(temp == "-dense"){
+               //the bit-matrices are only read by direct counting
+               framework.denseMode=true;
+               framework.directMode=true;
+           }
+           else if(temp == "-stats"){
+               writeStats=true;
+           }
+           else if(temp == "-direct"){
+               framework.directMode=true;
+           }
+           else if(temp == "-threads"){
+               framework.numThreads=atoi(argv[++i]);
+           }
+           else if(temp == "-pipeline"){
+               framework.pipelineMode=true;
+           }
+           else if(temp == "-dealthreads"){
+               framework.dealThreads=atoi(argv[++i]);
+           }
+           else if(temp == "-seed"){
+               framework.seed=atoll(argv[++i]);
+           }
+           else if(temp == "-ovlp"){
+               framework.distinctMode=true;
+               framework.ovlpThresh=atof(argv[++i]);
+           }
+           else if(temp == "-topk"){
+               topKMode=true;
+               framework.topKK=atoi(argv[++i]);
+           }
+           else if(temp == "-quality"){
+               framework.qualityMode=atoi(argv[++i]);
+           }
+           else if(temp == "-beta"){
+               framework.beta=atof(argv[++i]);
+           }
+           else if(temp == "-jacobi"){
+               framework.jacobiMode=true;
+           }
            else if(temp =="-reward"){
                framework.rewardMode=atoi(argv[++i]);
            }
@@ -125,6 +203,8 @@ void OutputClustersFile(){
     framework.OUT2.close();
 }
 void OutputStats(){
+    //the deals count their set operations per thread
+    CollectOpCounts();
     ofstream outStat("stats");
     outStat<<"\nAlgorithm execution time: "<<ComputeTime()
            <<"\nTotal iterations : "<<framework.totalIters
@@ -133,7 +213,12 @@ void OutputStats(){
            <<"\n# set intersections "<<numIntersection
            <<"\n# subset checks "<<numSubset
            <<"\n# set unions "<<numUnion
-           <<"\n# set differences "<<numDifference;
+           <<"\n# set differences "<<numDifference
+           <<"\n# add candidates "<<framework.numAddCandidates
+           <<"\n# add candidates pruned by reward bound "<<framework.numPruned
+           <<"\n# add candidates outside the frontier "<<framework.numOffFrontier
+           <<"\n# deals discarded at commit "<<framework.numConflicts
+           <<"\n# simultaneous deals that oscillated "<<framework.numOscillations;
     outStat.close();
 }
 int main(int argc, char** argv) {
@@ -145,10 +230,15 @@ int main(int argc, char** argv) {
         framework.InitTiring();
     StartTiming();
     framework.GHIN_Alg();
+    framework.SortTopK();
+    if(framework.distinctMode)
+        framework.RetainDistinct();
     EndTiming();
-    if( framework.enumerationMode == framework.ENUM_FILE){
+    if( framework.enumerationMode == framework.ENUM_FILE || framework.enumerationMode == framework.ENUM_TOPK_FILE){
          OutputClustersFile();
     }
+    if(writeStats)
+        OutputStats();
 
 
     cout<<"\n";
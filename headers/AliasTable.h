@@ -0,0 +1,68 @@
+/*!
+ Walker's alias method (in the numerically stable form of M. D. Vose, "A linear
+ algorithm for generating random numbers with a given distribution", 1991) for
+ drawing indices with given weights. Building a table takes O(n); a draw then picks
+ a column uniformly and flips one biased coin, O(1) whatever the number of weights,
+ where WeightedUniformDraw scans the weights.
+
+ The frequency weights of a domain depend on the objects that can still be sampled,
+ which change only when a cluster is committed, so most seed draws of a run compute
+ the same weights again. AliasCache keeps the table of every domain together with the
+ version of the selection sets it was computed from (see Ghin::UpdateSampleSet), and
+ the sampler reuses a table while the version matches, without looking at the sets.
+
+ \sa random_sample.h
+ \sa Rng.h
+ */
+
+#ifndef ALIASTABLE_H
+#define	ALIASTABLE_H
+
+#include "core.h"
+#include "Rng.h"
+
+using namespace std;
+
+class AliasTable {
+public:
+    //! Empty table
+    AliasTable();
+
+    //! Builds the table of weights, which need not sum to 1; returns false, leaving the table empty, if their sum is 0
+    bool Build(const vector<long double> &weights);
+    //! Returns index i with probability weights[i]/sum, the table must not be empty
+    int Draw(Rng &rng) const;
+    //! Returns index i with probability weights[i]/sum for u uniform in [0,1), the table must not be empty
+    int Draw(double u) const;
+    //! Returns the number of weights, 0 if the table is empty
+    int Size() const { return prob.size(); }
+
+private:
+    //! probability of keeping column i instead of taking alias[i]
+    vector<double> prob;
+    //! index that shares column i
+    vector<int> alias;
+};
+
+//! Alias tables of the weights of every domain, stored with the version of the sets they were computed from
+class AliasCache {
+public:
+    //! Empty cache
+    AliasCache();
+
+    //! Returns the table of domain s computed from version of the sets, NULL if there is none
+    AliasTable *Find(int s, long version);
+    //! Returns the table of domain s, to be rebuilt by the caller from version of the sets
+    AliasTable *Store(int s, long version);
+
+private:
+    struct Entry {
+        //! version of the sets the table was computed from, -1 if the entry is unused
+        long version;
+        AliasTable table;
+    };
+    //! the entry of domain s is entries[s]
+    vector<Entry> entries;
+};
+
+#endif	/* ALIASTABLE_H */
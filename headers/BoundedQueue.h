@@ -0,0 +1,169 @@
+/*!
+ Bounded lock-free multi-producer multi-consumer queue (D. Vyukov's array queue).
+ Every cell of a power of two sized ring carries a sequence number that tells
+ producers and consumers whether the cell is free for the current lap, so a push or
+ a pop is one compare-and-swap on the shared position plus a release store on the
+ cell. Elements are moved in and out, so handing a FlatCluster from one stage to
+ another transfers its block instead of copying it.
+
+ TryPush() and TryPop() never block. Push() and Pop() retry SPIN_TRIES times,
+ yielding the processor in between, which covers the short waits of stages that are
+ mostly busy computing. After that they sleep on a condition variable until the other
+ side makes room or adds an element, so an idle stage does not burn a core. A push or
+ pop only takes the mutex to wake a sleeper when one has registered, so the lock-free
+ path stays lock-free while nobody sleeps.
+
+ \sa ValueSets.h
+ */
+
+#ifndef BOUNDEDQUEUE_H
+#define	BOUNDEDQUEUE_H
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+template<class T>
+class BoundedQueue {
+public:
+    //! Queue of at least capacity elements, rounded up to a power of two
+    BoundedQueue(int capacity){
+        int n = 1;
+        while (n < capacity) n <<= 1;
+        cells = vector<Cell>(n);
+        mask = n-1;
+        for(int i=0; i < n; i++) cells[i].seq.store(i,memory_order_relaxed);
+        head.store(0,memory_order_relaxed);
+        tail.store(0,memory_order_relaxed);
+        pushWaiters.store(0,memory_order_relaxed);
+        popWaiters.store(0,memory_order_relaxed);
+    }
+
+    //! number of failed attempts of Push() and Pop() before they sleep
+    static const int SPIN_TRIES=64;
+
+    //! Returns the number of elements the queue holds when full
+    int Capacity() const { return mask+1; }
+
+    //! Moves x into the queue, returns false (and leaves x alone) if the queue is full
+    bool TryPush(T &x){
+        size_t pos = tail.load(memory_order_relaxed);
+        while (true){
+            Cell &c = cells[pos & mask];
+            size_t seq = c.seq.load(memory_order_acquire);
+            long diff = (long)seq - (long)pos;
+            if (diff == 0){
+                if (tail.compare_exchange_weak(pos,pos+1,memory_order_relaxed)){
+                    c.value = std::move(x);
+                    c.seq.store(pos+1,memory_order_release);
+                    return true;
+                }
+            }else if (diff < 0){
+                return false;
+            }else{
+                pos = tail.load(memory_order_relaxed);
+            }
+        }
+    }
+
+    //! Moves the oldest element into x, returns false if the queue is empty
+    bool TryPop(T &x){
+        size_t pos = head.load(memory_order_relaxed);
+        while (true){
+            Cell &c = cells[pos & mask];
+            size_t seq = c.seq.load(memory_order_acquire);
+            long diff = (long)seq - (long)(pos+1);
+            if (diff == 0){
+                if (head.compare_exchange_weak(pos,pos+1,memory_order_relaxed)){
+                    x = std::move(c.value);
+                    c.seq.store(pos+mask+1,memory_order_release);
+                    return true;
+                }
+            }else if (diff < 0){
+                return false;
+            }else{
+                pos = head.load(memory_order_relaxed);
+            }
+        }
+    }
+
+    //! Moves x into the queue, waiting while it is full
+    void Push(T &x){
+        if (!Spin(&BoundedQueue::TryPush,x))
+            Sleep(&BoundedQueue::TryPush,x,pushWaiters,notFull);
+        Wake(popWaiters,notEmpty);
+    }
+
+    //! Moves the oldest element into x, waiting while the queue is empty
+    void Pop(T &x){
+        if (!Spin(&BoundedQueue::TryPop,x))
+            Sleep(&BoundedQueue::TryPop,x,popWaiters,notEmpty);
+        Wake(pushWaiters,notFull);
+    }
+
+private:
+    typedef bool (BoundedQueue::*Attempt)(T &);
+
+    //! calls attempt up to SPIN_TRIES times, returns false if it never succeeded
+    bool Spin(Attempt attempt, T &x){
+        for(int i=0; i < SPIN_TRIES; i++){
+            if ((this->*attempt)(x))
+                return true;
+            this_thread::yield();
+        }
+        return false;
+    }
+
+    //! calls attempt until it succeeds, sleeping on cv in between; waiters counts the sleepers of cv
+    void Sleep(Attempt attempt, T &x, atomic<int> &waiters, condition_variable &cv){
+        unique_lock<mutex> guard(lock);
+        waiters.fetch_add(1);
+        //the registration must be visible before the retry, see Wake()
+        atomic_thread_fence(memory_order_seq_cst);
+        while (!(this->*attempt)(x))
+            cv.wait(guard);
+        waiters.fetch_sub(1);
+    }
+
+    //! wakes a sleeper of cv after a push or pop, if there is one
+    void Wake(atomic<int> &waiters, condition_variable &cv){
+        //pairs with the fence of Sleep(): either the sleeper sees the change in its retry
+        //under the lock, or this sees the sleeper and notifies it once it waits
+        atomic_thread_fence(memory_order_seq_cst);
+        if (waiters.load(memory_order_relaxed) > 0){
+            lock_guard<mutex> guard(lock);
+            cv.notify_one();
+        }
+    }
+
+    //! one slot of the ring
+    struct Cell {
+        atomic<size_t> seq;
+        T value;
+        Cell() {}
+        //! only used while the ring is allocated, before it is shared
+        Cell(const Cell &c) : seq(c.seq.load(memory_order_relaxed)), value(c.value) {}
+    };
+    //! ring of mask+1 cells
+    vector<Cell> cells;
+    size_t mask;
+    //! position of the next pop, on its own cache line
+    alignas(64) atomic<size_t> head;
+    //! position of the next push, on its own cache line
+    alignas(64) atomic<size_t> tail;
+    //! threads sleeping in Push() and in Pop()
+    alignas(64) atomic<int> pushWaiters;
+    atomic<int> popWaiters;
+    //! guards the sleeping, see Sleep()
+    mutex lock;
+    //! signalled when an element was popped
+    condition_variable notFull;
+    //! signalled when an element was pushed
+    condition_variable notEmpty;
+};
+
+#endif	/* BOUNDEDQUEUE_H */
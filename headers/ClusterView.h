@@ -0,0 +1,166 @@
+/*!
+ A view over the candidate n-cluster of a deal in the GHIN framework. The view keeps,
+ for each domain of the HIN, a HybridSet copy of the corresponding set of the n-cluster
+ so that reward functions can probe cluster membership in the container best suited
+ to the density of the set. Whenever a set of the underlying n-cluster is changed the
+ view must be refreshed for that domain. The view also carries the CSR copies of the
+ contexts, through which reward functions read object-sets. When some context has a
+ bit-matrix the view also keeps every set of the n-cluster as a bitmap mask, and
+ Overlap() counts with a popcount of row & mask for those contexts.
+
+ When the view is given OverlapCounts it keeps them in sync with the n-cluster instead,
+ and Overlap() is a counter lookup. Sets must then be changed through Add() and
+ Remove(), which update the counters in time proportional to the degrees of the
+ objects that changed; no hybrid sets or masks are kept in this case.
+
+ Overlaps() gives the overlaps of all objects of a domain at once, for reward functions
+ that score a whole domain in one pass. Without counters it computes them with a single
+ scatter-add over the object-sets of the members of C_t, i.e. a sparse matrix - vector
+ product with the indicator vector of C_t.
+
+ The buffers and work counters of the reward functions are kept per domain, so the
+ steps of different domains can be computed at the same time as long as the sets are
+ not changed meanwhile.
+
+ \sa HybridSet
+ \sa Framework.h
+ */
+
+#ifndef CLUSTERVIEW_H
+#define	CLUSTERVIEW_H
+
+#include "HybridSet.h"
+#include "CsrContext.h"
+#include "OverlapCounts.h"
+#include "ZTables.h"
+
+using namespace std;
+
+//! Counters of the work done by the reward functions through a view
+struct DealStats {
+    //! rounds of best responses
+    double nashIters;
+    //! objects outside the cluster considered for addition
+    double addCandidates;
+    //! candidates skipped because their reward bound was not positive
+    double pruned;
+    //! candidates skipped because they lie outside the frontier
+    double offFrontier;
+    //! simultaneous best responses that oscillated
+    double oscillations;
+
+    DealStats() : nashIters(0), addCandidates(0), pruned(0), offFrontier(0), oscillations(0) {}
+    //! Adds the counters of b
+    void Add(const DealStats &b){
+        nashIters += b.nashIters;
+        addCandidates += b.addCandidates;
+        pruned += b.pruned;
+        offFrontier += b.offFrontier;
+        oscillations += b.oscillations;
+    }
+};
+
+class ClusterView {
+public:
+    //! Builds the hybrid sets of every domain of a, the domain sizes are taken from hin
+    /*!
+        \param a the n-cluster, one set per domain of hin
+        \param hin the information network
+        \param csr CSR copies of the contexts of hin
+        \param counts if not NULL, reset to the overlaps with a and used by Overlap()
+     */
+    ClusterView(NCluster *a, RelationGraph *hin, CsrGraph *csr, OverlapCounts *counts);
+
+    //! Rebuilds the hybrid set of the specified domain from the underlying n-cluster
+    void Refresh(int domain);
+    //! Adds the objects of delta (not in the set yet) to the set with id domain and updates the view
+    void Add(int domain, IOSet *delta);
+    //! Removes the objects of delta (all in the set) from the set with id domain and updates the view
+    void Remove(int domain, IOSet *delta);
+
+    //! Returns the underlying n-cluster
+    NCluster *GetCluster() { return c; }
+    //! Returns the set of the underlying n-cluster with id domain, without searching the n-cluster
+    IOSet *GetSetById(int domain) { return sets[domain]; }
+    //! Returns the hybrid copy of the set with id domain
+    HybridSet *GetHybrid(int domain) { return &hsets[domain]; }
+    //! Returns the CSR copies of the contexts of the information network
+    CsrGraph *GetCsr() { return csr; }
+    //! Returns |object-set of obj in ctx intersect the set with id t|
+    /*!
+        \param ctx CSR copy of the context between domain and t
+        \param domain the domain of obj
+        \param obj the object
+        \param t the other domain of ctx
+     */
+    int Overlap(CsrContext *ctx, int domain, int obj, int t){
+        if (counts != NULL)
+            return counts->Get(domain,t,obj);
+        if (ctx->IsDense())
+            return BitAndCount(ctx->GetRow(domain,obj), &masks[t][0], ctx->GetNumWords(domain));
+        SetSpan row = ctx->GetSet(domain,obj);
+        return hsets[t].IntersectCount(row.data,row.size);
+    }
+    //! Returns the overlaps of all objects of domain with the set with id t, see Overlap()
+    /*!
+        The returned array holds ctx->GetNumSets(domain) counts and is valid until the next
+        call for domain or the next change of the view.
+     */
+    const int *Overlaps(CsrContext *ctx, int domain, int t);
+    //! Returns the frontier of domain (see OverlapCounts::GetFrontier), NULL without counters
+    const vector<int> *GetFrontier(int domain) { return counts != NULL ? &counts->GetFrontier(domain) : NULL; }
+    //! Returns a buffer for per-object scores of domain owned by the view
+    vector<double> &GetScores(int domain) { return scratch[domain].scores; }
+    //! Returns a buffer for per-object reward upper bounds of domain owned by the view
+    vector<double> &GetBounds(int domain) { return scratch[domain].bounds; }
+    //! Returns a buffer for candidate objects of domain owned by the view
+    vector<int> &GetCandidates(int domain) { return scratch[domain].candidates; }
+    //! Returns n buffers of objects of domain owned by the view, one per chunk of a parallel loop
+    vector< vector<int> > &GetChunkBuffers(int domain, int n) {
+        if (scratch[domain].chunks.size() < n) scratch[domain].chunks.resize(n);
+        return scratch[domain].chunks;
+    }
+    //! Returns the z-score table of the objects of domain against the set with id t
+    ZTable *GetZTable(int domain, int t) { return &ztables[domain][t]; }
+    //! Returns the counters of the work done for domain
+    DealStats &GetStats(int domain) { return scratch[domain].stats; }
+    //! Returns the counters of the work done for all domains
+    DealStats GetStats() const;
+
+private:
+    //! the underlying n-cluster
+    NCluster *c;
+    //! the information network, used for domain sizes
+    RelationGraph *hin;
+    //! CSR copies of the contexts of hin
+    CsrGraph *csr;
+    //! sets of the n-cluster indexed by domain id
+    vector<IOSet*> sets;
+    //! hybrid sets indexed by domain id
+    vector<HybridSet> hsets;
+    //! bitmap of every set indexed by domain id, only kept when csr has a bit-matrix
+    vector< vector<unsigned long long> > masks;
+    //! incremental overlap counters, NULL when overlaps are counted from the sets
+    OverlapCounts *counts;
+    //! buffers of the reward functions for one domain
+    struct Scratch {
+        //! result of Overlaps() when there are no counters
+        vector<int> bulk;
+        //! per-object scores of bulk reward functions
+        vector<double> scores;
+        //! per-object upper bounds of the reward
+        vector<double> bounds;
+        //! candidate objects of the current step
+        vector<int> candidates;
+        //! results of the chunks of a parallel loop
+        vector< vector<int> > chunks;
+        //! work counters
+        DealStats stats;
+    };
+    //! buffers indexed by domain id
+    vector<Scratch> scratch;
+    //! z-score tables indexed by domain id and neighbor domain id
+    vector< vector<ZTable> > ztables;
+};
+
+#endif	/* CLUSTERVIEW_H */
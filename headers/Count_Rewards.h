@@ -12,20 +12,105 @@
 #define	COUNT_REWARDS_H
 
 #include "core.h"
+#include "ClusterView.h"
 
 
 
 /*!
- Computes the simple weighted score. See Alqadah et al. in KDD '11 for details
- \params a the ncluster to compute score for
- \param obj the object id to compute for
- \param doamin the domain id for which to compute the score with respect to
-  \param w the weight paramater (see Alqadah et al. KDD 2011)
- \param hin the information network
-
+ Reward policy of the simple weighted score. The scoring code is inline so that the deal
+ steps instantiated for this policy (see Ghin::AddSet_Reward) can inline it.
  */
-double Simple_Weighted_Score(NCluster *a, int obj, int domain, double w, RelationGraph *hin);
+struct SimpleWeightedReward {
+    /*!
+     Computes the simple weighted score. See Alqadah et al. in KDD '11 for details
+     \param a view of the ncluster to compute score for
+     \param obj the object id to compute for
+     \param domain the domain id for which to compute the score with respect to
+     \param w the weight paramater (see Alqadah et al. KDD 2011)
+     \param hin the information network
+     */
+    static inline double Score(ClusterView *a, int obj, int domain, double w, RelationGraph *hin){
+        const vector<int> &neighbors = a->GetCsr()->GetNeighbors(domain);
+        const vector<CsrContext*> &contexts = a->GetCsr()->GetContexts(domain);
+        double score = 0.0;
+        for(int i=0; i < neighbors.size(); i++){
+            double B= a->GetSetById( neighbors[i])->Size() ;
+            if(B > 0){
+                CsrContext *currContext = contexts[i];
+                double ones = a->Overlap(currContext,domain,obj,neighbors[i]);
+                double zeros = B - ones;
+                score += (ones - w*zeros) / B;
+            }
+        }
+        return score;
+    }
+
+    //! Computes Score for every object of domain in one pass over the domain, the score of object i at index i of scores
+    static inline void Scores(ClusterView *a, int domain, double w, RelationGraph *hin, vector<double> &scores){
+        const vector<int> &neighbors = a->GetCsr()->GetNeighbors(domain);
+        const vector<CsrContext*> &contexts = a->GetCsr()->GetContexts(domain);
+        int numObjs = hin->NumObjsInDomain(domain);
+        scores.assign(numObjs,0.0);
+        double *score = scores.data();
+        for(int i=0; i < neighbors.size(); i++){
+            double B= a->GetSetById( neighbors[i])->Size() ;
+            if(B > 0){
+                const int *ones = a->Overlaps(contexts[i],domain,neighbors[i]);
+                //same expression as Score so the scores are identical
+                for(int obj=0; obj < numObjs; obj++){
+                    double zeros = B - ones[obj];
+                    score[obj] += (ones[obj] - w*zeros) / B;
+                }
+            }
+        }
+    }
+
+    //! Upper bounds of Score for all objects of domain, from the degrees and set sizes only
+    /*!
+        For w >= 0 the score grows with the number of ones, which is at most min(degree,B), so
+        evaluating the same expression with that many ones bounds the score from above. For
+        negative w every bound is HUGE_VAL.
+     */
+    static inline void Bounds(ClusterView *a, int domain, double w, RelationGraph *hin, vector<double> &bounds){
+        const vector<int> &neighbors = a->GetCsr()->GetNeighbors(domain);
+        const vector<CsrContext*> &contexts = a->GetCsr()->GetContexts(domain);
+        int numObjs = hin->NumObjsInDomain(domain);
+        if (w < 0){
+            bounds.assign(numObjs,HUGE_VAL);
+            return;
+        }
+        bounds.assign(numObjs,0.0);
+        double *bound = bounds.data();
+        for(int i=0; i < neighbors.size(); i++){
+            double B= a->GetSetById( neighbors[i])->Size() ;
+            if(B > 0){
+                const int *degrees = contexts[i]->GetDegrees(domain);
+                for(int obj=0; obj < numObjs; obj++){
+                    double ones = degrees[obj] < B ? degrees[obj] : B;
+                    double zeros = B - ones;
+                    bound[obj] += (ones - w*zeros) / B;
+                }
+            }
+        }
+    }
+
+    //! Upper bound of Score for the objects of domain that share no object with the cluster in any context
+    /*!
+        Every term is then (0 - w*B)/B = -w, so the bound is at most 0 for w >= 0.
+     */
+    static inline double ZeroOverlapBound(ClusterView *a, int domain, double w, RelationGraph *hin){
+        const vector<int> &neighbors = a->GetCsr()->GetNeighbors(domain);
+        double bound = 0.0;
+        for(int i=0; i < neighbors.size(); i++){
+            if(a->GetSetById( neighbors[i])->Size() > 0)
+                bound += -w;
+        }
+        return bound;
+    }
 
+    //! Makes Score safe to call from several threads for domain, nothing to do for this policy
+    static inline void Prepare(ClusterView *a, int domain, RelationGraph *hin){}
+};
 
 
 
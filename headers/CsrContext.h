@@ -0,0 +1,173 @@
+/*!
+ Immutable compressed sparse row (CSR) copies of the contexts of a HIN. A Context of the
+ core library keeps every object-set as a separate IOSet; a CsrContext keeps, for each of
+ the two orientations, one offsets array and one contiguous array holding the object-sets
+ of all objects back to back. GetSet() returns a SetSpan, a pointer and a length into that
+ array, so looking up an object-set neither allocates nor chases a pointer per set.
+
+ A CsrContext can in addition hold a dense bit-matrix of both orientations, where the
+ object-set of an object is a row of 64 bit words. For dense contexts counting the overlap
+ of an object-set with a set held as a bitmap is then a popcount over a few words per
+ row instead of a merge.
+
+ CsrGraph builds the CSR copy of every context of a RelationGraph once. It also indexes
+ the topology of the network: contexts are found through a table indexed by the pair of
+ domain ids, and the neighbors of every domain (with the matching contexts) are cached
+ and returned by reference, so none of these lookups searches or allocates. Depending
+ on the mode, contexts denser than DENSE_THRESHOLD (or all of them, or none) also get
+ the bit-matrix.
+
+ \sa Context
+ \sa RelationGraph
+ */
+
+#ifndef CSRCONTEXT_H
+#define	CSRCONTEXT_H
+
+#include "core.h"
+
+using namespace std;
+
+//! A read-only sorted run of object ids, it does not own the memory
+struct SetSpan {
+    //! first element
+    const unsigned int *data;
+    //! number of elements
+    int size;
+
+    //! Returns the number of elements
+    int Size() const { return size; }
+    //! Returns the ith element
+    unsigned int At(int i) const { return data[i]; }
+    //! Returns a pointer to the first element
+    const unsigned int *Begin() const { return data; }
+    //! Returns a pointer past the last element
+    const unsigned int *End() const { return data+size; }
+};
+
+class CsrContext {
+public:
+    //! Builds both orientations of c
+    CsrContext(Context *c);
+
+    //! Returns the object-set of object setNum of the specified domain, same contents as Context::GetSet
+    SetSpan GetSet(int domain, int setNum) const {
+        const Side &sd = domain == d1 ? s1 : s2;
+        SetSpan ret = { &sd.adj[0] + sd.offsets[setNum], (int)(sd.offsets[setNum+1] - sd.offsets[setNum]) };
+        return ret;
+    }
+    //! Returns the size of the object-set of object setNum of the specified domain
+    int GetDegree(int domain, int setNum) const {
+        const Side &sd = domain == d1 ? s1 : s2;
+        return sd.offsets[setNum+1] - sd.offsets[setNum];
+    }
+    //! Returns the sizes of the object-sets of all objects of the specified domain
+    const int *GetDegrees(int domain) const { return domain == d1 ? s1.degrees.data() : s2.degrees.data(); }
+    //! Returns the distinct object-set sizes of the specified domain in ascending order
+    const vector<int> &GetDistinctDegrees(int domain) const { return domain == d1 ? s1.distinct : s2.distinct; }
+    //! Return the number of objects for the specifed domain
+    int GetNumSets(int domain) const { return domain == d1 ? s1.offsets.size()-1 : s2.offsets.size()-1; }
+    //! Return the number of ones or relations between objects in domain1 and domain2
+    int GetNumOnes() const { return s1.adj.size() - 1; }
+    //! Return the number of ones / |domain1|*|domain2|
+    double GetDensity() const;
+    //! Returns an interger pair corresponding to the ids of the domains
+    pair<int,int> GetDomainIds() const { return make_pair(d1,d2); }
+    //! Returns the context this copy was built from
+    Context *GetContext() const { return ctx; }
+
+    //! Builds the bit-matrix of both orientations
+    void MakeDense();
+    //! Returns true if the bit-matrix has been built
+    bool IsDense() const { return dense; }
+    //! Returns the number of 64 bit words of a row of the specified domain
+    int GetNumWords(int domain) const { return domain == d1 ? s1.words : s2.words; }
+    //! Returns the bit-matrix row of object setNum of the specified domain, requires IsDense()
+    const unsigned long long *GetRow(int domain, int setNum) const {
+        const Side &sd = domain == d1 ? s1 : s2;
+        return &sd.bits[0] + (long)setNum*sd.words;
+    }
+
+private:
+    //! one orientation of the context
+    struct Side {
+        //! object-set of object i is adj[offsets[i] .. offsets[i+1])
+        vector<unsigned int> offsets;
+        //! all object-sets, followed by one padding element so adj[0] is always valid
+        vector<unsigned int> adj;
+        //! size of the object-set of every object
+        vector<int> degrees;
+        //! distinct values of degrees, ascending
+        vector<int> distinct;
+        //! words per bit-matrix row
+        int words;
+        //! bit-matrix, row i is bits[i*words .. (i+1)*words), empty unless dense
+        vector<unsigned long long> bits;
+    };
+
+    //! Fills sd from the object-sets of domain in c
+    static void Build(Context *c, int domain, Side &sd);
+    //! Fills the bit-matrix of sd, rows have numCols columns
+    static void BuildBits(Side &sd, int numCols);
+
+    //! id of the first domain
+    int d1;
+    //! id of the second domain
+    int d2;
+    //! object-sets of the objects in d1
+    Side s1;
+    //! object-sets of the objects in d2
+    Side s2;
+    //! the context the copy was built from
+    Context *ctx;
+    //! true if the bit-matrix is built
+    bool dense;
+};
+
+class CsrGraph {
+public:
+    //! contexts with a density above this get a bit-matrix in DENSE_AUTO mode
+    static const double DENSE_THRESHOLD;
+    //! no context gets a bit-matrix
+    static const int DENSE_NONE=0;
+    //! contexts with a density above DENSE_THRESHOLD get a bit-matrix
+    static const int DENSE_AUTO=1;
+    //! every context gets a bit-matrix
+    static const int DENSE_ALL=2;
+
+    //! Builds the CSR copy of every context of hin
+    /*!
+        \param hin the information network
+        \param denseMode one of DENSE_NONE, DENSE_AUTO or DENSE_ALL
+     */
+    CsrGraph(RelationGraph *hin, int denseMode);
+    //! Destructor
+    ~CsrGraph();
+
+    //! Returns the CSR copy of the context between domains s and t, NULL if there is none
+    CsrContext *GetContext(int s, int t) { return table[s][t]; }
+    //! Returns the ids of the domains that share a context with domain, in the order of RelationGraph::GetNeighbors
+    const vector<int> &GetNeighbors(int domain) { return neighbors[domain]; }
+    //! Returns the contexts of domain, the ith one is shared with GetNeighbors(domain)[i]
+    const vector<CsrContext*> &GetContexts(int domain) { return contexts[domain]; }
+    //! Returns the index of t in GetNeighbors(domain), -1 if t is not a neighbor
+    int GetNeighborIndex(int domain, int t) const { return slot[domain][t]; }
+    //! Returns true if at least one context has a bit-matrix
+    bool HasDense() const { return numDense > 0; }
+
+private:
+    //! every copy once, owned by the graph
+    vector<CsrContext*> all;
+    //! table[s][t] is the copy of the context between domains s and t, or NULL
+    vector< vector<CsrContext*> > table;
+    //! neighbors of every domain, indexed by domain id
+    vector< vector<int> > neighbors;
+    //! contexts of every domain, indexed by domain id and aligned with neighbors
+    vector< vector<CsrContext*> > contexts;
+    //! slot[d][t], index of t in neighbors[d] or -1
+    vector< vector<int> > slot;
+    //! number of contexts with a bit-matrix
+    int numDense;
+};
+
+#endif	/* CSRCONTEXT_H */
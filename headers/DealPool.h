@@ -0,0 +1,38 @@
+/*!
+ Object pool for the temporary n-clusters created while a deal is worked out in the
+ GHIN framework, currently the copy of the selection sets a seed is sampled from.
+ Objects handed out by the pool stay owned by the pool and must not be deleted; they
+ are valid until Reset() is called, which returns every object to the pool at once.
+ Returned objects keep the memory they acquired, so after the first few deals a run no
+ longer goes to the allocator for its temporaries.
+
+ \sa Framework.h
+ */
+
+#ifndef DEALPOOL_H
+#define	DEALPOOL_H
+
+#include "core.h"
+
+using namespace std;
+
+class DealPool {
+public:
+    //! Default constructor, the pool starts empty and grows on demand
+    DealPool();
+    //! Destructor, destroys every object of the pool
+    ~DealPool();
+
+    //! Returns a pooled deep copy of a, including the ids of its sets
+    NCluster *CopyCluster(NCluster *a);
+
+    //! Returns every object handed out since the last reset to the pool
+    void Reset();
+
+private:
+    //! all n-clusters of the pool, the first clustersUsed are handed out
+    vector<NCluster*> clusters;
+    int clustersUsed;
+};
+
+#endif	/* DEALPOOL_H */
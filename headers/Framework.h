@@ -19,6 +19,12 @@
 #include "Z_Rewards.h"
 #include "Count_Rewards.h"
 #include "random_sample.h"
+#include "WorkerPool.h"
+#include "BoundedQueue.h"
+#include "ValueSets.h"
+#include "RepeatIndex.h"
+#include "TopKOverlap.h"
+#include "Rng.h"
 
 using namespace std;
 
@@ -31,7 +37,35 @@ Ghin():LatticeAlgos() {
     totalIters=0;
     totalCands=0;
     avgNashIters=0;
+    numAddCandidates=0;
+    numPruned=0;
+    numOffFrontier=0;
+    numConflicts=0;
+    numOscillations=0;
+    jacobiMode=false;
+    pipelineMode=false;
+    distinctMode=false;
+    numThreads=1;
+    seed=-1;
+    beta=0.5;
+    dealThreads=1;
+    scorePool=NULL;
+    csr=NULL;
+    overlaps=NULL;
+    distinctIndex=NULL;
+    sampledSelection=NULL;
+    selectionVersion=0;
+    reward=NULL;
+    denseMode=false;
+    directMode=false;
 };
+//! Destructor
+~Ghin(){
+    delete scorePool;
+    delete overlaps;
+    delete distinctIndex;
+    delete csr;
+}
 
 
 /*!
@@ -43,8 +77,9 @@ Ghin():LatticeAlgos() {
   \param domain the domaain to seed for an initial candidate
   \param sampleSet the sample set from which to draw objects
   \param clustered objects that have already been clustered
+  \param rng source of the random choices
  */
-NCluster* SelectInit(int domain, NCluster *sampleSet, NCluster *clustered);
+NCluster* SelectInit(int domain, NCluster *sampleSet, NCluster *clustered, Rng &rng);
 
 
 /*!
@@ -52,22 +87,47 @@ NCluster* SelectInit(int domain, NCluster *sampleSet, NCluster *clustered);
  This method samples connected n-clusters across the hin by using random sampling of itemsets
  ~ to frequency or support
   \param sampleSet the sample set from which to draw objects
+  \param pool backs the temporaries of the sampler
+  \param rng source of the random choices
 
  */
-NCluster* SelectInit_RandomFreq(NCluster *sampleSet);
+NCluster* SelectInit_RandomFreq(NCluster *sampleSet, DealPool *pool, Rng &rng);
 
 /*!
-  Iterate until a nash equalibrium is reached or return NULL
+  Iterate until a nash equalibrium is reached. The candidate is modified in place and
+  handed back as the result (ownership moves to the caller, nothing is copied), with
+  quality 1 if an equalibrium was reached and 0 otherwise.
+  Every round updates the domains one after another in a random order, or in jacobiMode
+  all at once with MaximizeAll. A jacobi deal that changes back to a state it has already
+  been in is finished one domain at a time.
+  \param counts overlap counters used for the deal, NULL to count from the sets
+  \param stats receives the work counters of the deal
+  \param rng source of the order of the domains
  */
 
-NCluster* MakeDeal(NCluster*);
+NCluster* MakeDeal(NCluster *candidate, OverlapCounts *counts, DealStats *stats, Rng &rng);
 
 /*!
-   Attempts to maximuze the reward of a single domain c while holding all other
-   selections constant
+   Attempts to maximuze the reward of a single domain while holding all other
+   selections constant. The set of the domain is updated in place through the view
+   if a change is made.
    Reutnrs true if a change is made otherwise false
  */
-bool MaximizeDomain(NCluster *, IOSet *c, int,bool);
+bool MaximizeDomain(ClusterView *, int,bool);
+
+/*!
+   Simultaneous (Jacobi) version of MaximizeDomain for all domains. The changes of every
+   domain are computed against the same state of the view, in parallel if there is a
+   scorePool, and then applied together.
+   Returns true if a change is made otherwise false
+   \param a view of the candidate
+   \param add true to add objects, false to remove them
+   \param deltas one set per domain id that receives the changes
+ */
+bool MaximizeAll(ClusterView *a, bool add, vector<IOSet> &deltas);
+
+//! Returns a 64 bit hash of the sets of c, used to detect oscillating deals
+static unsigned long long Fingerprint(NCluster *c);
 
 
 
@@ -92,16 +152,123 @@ void UpdateSampleSet(NCluster*,NCluster*);
            4. If deal is made with C update selection set
 
 
- Assumes RewardFunc variable has been set.
+ Assumes the reward function has been selected with SetRewardMode. With numThreads > 1
+ the deals are run by GHIN_Alg_Threads, or by GHIN_Alg_Pipeline in pipeline mode.
  */
 void GHIN_Alg();
 
+//! State shared by the threads of GHIN_Alg_Threads
+struct ThreadRun;
 
+/*!
+  Parallel version of steps 3-4 of GHIN_Alg. Each of numThreads threads repeatedly draws
+  a seed from the selection sets (under a lock, since sampling reads them), runs the deal
+  without the lock against its own overlap counters, and then commits the result. Results
+  are committed in the order the seeds were drawn, each one after the next numThreads-1
+  seeds are drawn, so every seed is drawn against the same commits in every run with the
+  same seed and number of threads. A result is discarded (numConflicts) if a cluster
+  committed after its seed was drawn took any of the seed objects, since the sequential
+  algorithm could not have drawn that seed; otherwise it is checked and committed exactly
+  as in GHIN_Alg.
+    \param selection the selection sets
+    \param clustered the objects clustered so far
+ */
+void GHIN_Alg_Threads(NCluster *selection, NCluster *clustered);
+
+//! Body of one thread of GHIN_Alg_Threads, counts are its overlap counters (NULL with directMode)
+void DealWorker(ThreadRun *run, OverlapCounts *counts);
+
+//! A seed drawn by the sampler of GHIN_Alg_Pipeline
+struct SeedItem;
+//! A finished deal on its way to the collector of GHIN_Alg_Pipeline
+struct DealItem;
+//! State shared by the stages of GHIN_Alg_Pipeline
+struct PipelineRun;
+
+/*!
+  Pipelined version of steps 3-4 of GHIN_Alg. A sampler thread draws seeds ahead of the
+  deals into a bounded queue, numThreads deal threads take seeds from it and pass their
+  results through a second queue, and the calling thread collects them: it checks and
+  commits the results in the order the seeds were drawn, exactly as GHIN_Alg_Threads
+  does, and sends every commit back to the sampler through a third queue.
+
+  The sampler draws from its own copy of the selection sets, to which it applies the
+  commits as they come back. Seed k is drawn once the commits of all seeds up to
+  k-numThreads-PIPELINE_PREFETCH are applied, so every seed is drawn against the same
+  commits in every run with the same seed and number of threads, and up to that many
+  seeds are in flight. The queues never block the sampling, the deals or the commits
+  on one another, which keeps the deal threads busy while the collector works.
+    \param selection the selection sets
+    \param clustered the objects clustered so far
+ */
+void GHIN_Alg_Pipeline(NCluster *selection, NCluster *clustered);
 
-//! Pointer to reward function
-//! the two integers specify the domains for which the reward function is computed
-//! these are naive implementations of reward functions
-double (*RewardFunc)(NCluster*,int,int,double,RelationGraph*);
+//! Sampler stage of GHIN_Alg_Pipeline
+void PipelineSampler(PipelineRun *run);
+
+//! Deal stage of GHIN_Alg_Pipeline, run by every deal thread, counts are its overlap counters (NULL with directMode)
+void PipelineDealer(PipelineRun *run, OverlapCounts *counts);
+
+//! Overlap counters of deal thread i, the first one gets overlaps and the others a new instance, NULL with directMode
+OverlapCounts *DealCounts(int i);
+
+//! Adds the work counters of a deal to the run statistics
+void AddStats(const DealStats &stats);
+
+//! Prints the sizes of the selection sets and the number of clusters found
+void DisplayProgress(NCluster *selection);
+
+/*!
+  Keeps the clusters of CONCEPTS of which no two overlap (AverageOverlap) by more than
+  ovlpThresh, the higher quality one (ClusterQuality) of two overlapping clusters, or the
+  one first in CONCEPTS if they are equal. The clusters keep their order. Does nothing in
+  the top K modes, where StoreCluster already retains the distinct clusters.
+ */
+void RetainDistinct();
+
+/*!
+  Takes ownership of a cluster found by the algorithm. Normally it is appended to
+  CONCEPTS. In the top K modes (ENUM_TOPK_MEM, ENUM_TOPK_FILE) CONCEPTS is a min-heap of
+  at most topKK clusters on ClusterQuality: c gets its quality and replaces the worst
+  cluster if the heap is full, or is deleted if it is not better than that one. With
+  distinctMode CONCEPTS is instead kept by RetainTopK_OverlapIndexed on distinctIndex
+  and distinctHeap, so c also replaces the worse clusters it overlaps, or is deleted if
+  it overlaps a better one.
+ */
+void StoreCluster(NCluster *c);
+
+//! In the top K modes orders CONCEPTS by decreasing quality, call once the run is done
+void SortTopK();
+
+//! Returns the quality of c selected by qualityMode: AREA, BETA or TOTAL_REWARD
+double ClusterQuality(NCluster *c);
+
+
+
+//! The deal steps of one reward function, instantiated for its reward policy
+struct RewardEntry {
+    //! value of the -reward option
+    int mode;
+    //! printable name
+    const char *name;
+    //! AddSet_Reward instantiated for the reward policy
+    bool (Ghin::*addSet)(ClusterView*,int,IOSet*);
+    //! RemoveSet_Reward instantiated for the reward policy
+    bool (Ghin::*removeSet)(ClusterView*,int,IOSet*);
+    //! TotalReward instantiated for the reward policy
+    double (Ghin::*totalReward)(NCluster*);
+};
+
+//! Registry of the reward functions, the last entry has mode -1
+static const RewardEntry REWARDS[];
+
+/*!
+ Selects the reward function registered for mode (see REWARDS), returns false if there is none
+ */
+bool SetRewardMode(int mode);
+
+//! the selected reward function, NULL until SetRewardMode succeeds
+const RewardEntry *reward;
 
 //! weight value that is used in conjuction with different reward functions
 double w;
@@ -111,6 +278,30 @@ double w;
 int rewardMode;
 //! run with tiring party-goer mode?
 bool tiredMode;
+//! give every context a bit-matrix, not only the dense ones; only read with directMode
+bool denseMode;
+//! count overlaps from the sets at every reward evaluation instead of keeping incremental counters
+bool directMode;
+//! number of threads running deals, 1 runs the sequential algorithm
+int numThreads;
+//! number of threads scoring the objects of a single deal step, see ScoreCandidates
+int dealThreads;
+//! update all domains at once in every round of a deal, see MaximizeAll
+bool jacobiMode;
+//! run the deal threads as a sampler, deal and collector pipeline, see GHIN_Alg_Pipeline
+bool pipelineMode;
+//! drop clusters that overlap a better one by more than ovlpThresh, see RetainDistinct
+bool distinctMode;
+//! key of the random streams, set from the clock by GHIN_Alg if negative
+long long seed;
+//! beta of the BETA quality mode
+double beta;
+//! quality mode that ranks clusters by the sum of the rewards of their objects, see TotalReward
+static const int TOTAL_REWARD=3;
+//! iteration i draws its seed from stream 2*i+SAMPLE_STREAM of Rng
+static const int SAMPLE_STREAM=0;
+//! iteration i runs its deal with stream 2*i+DEAL_STREAM of Rng
+static const int DEAL_STREAM=1;
 //! The simple weighted zeros reward function
 static const int SIMPLE_WEIGHTED=1;
 //! Expected satisfaction reward function using hyper-geomtric distribution
@@ -121,6 +312,26 @@ static const int EXPECTED_BETABINOMIAL_SAT=3;
 ///////////////////////Data Structs/////////////////////////////////////////////
 //! pointer to a hin
 RelationGraph *hin;
+//! CSR copies of the contexts of hin, built at the start of GHIN_Alg
+CsrGraph *csr;
+//! incremental overlap counters shared by all deals, NULL in direct mode
+OverlapCounts *overlaps;
+//! backs the temporaries of a single deal, reset when the deal is finished
+DealPool dealPool;
+//! alias tables of the seed sampling weights, only used by the thread drawing the seeds
+AliasCache sampleTables;
+//! the selection sets seeds are drawn from, see SampleFrom
+NCluster *sampledSelection;
+//! version of the sets of sampledSelection, the key of sampleTables, changed by every update
+long selectionVersion;
+//! threads shared by the scoring loops of all deals, NULL if dealThreads is 1
+WorkerPool *scorePool;
+//! index of the sets of CONCEPTS, see CheckRepeat
+RepeatIndex repeats;
+//! index of the overlaps among CONCEPTS in the top K modes with distinctMode, see StoreCluster
+OverlapIndex *distinctIndex;
+//! quality heap of CONCEPTS in the top K modes with distinctMode, see StoreCluster
+QualityHeap distinctHeap;
 vector< vector<double> > tired;
 
 
@@ -131,6 +342,22 @@ int totalIters;
 double totalCands;
 //! avg number of iterations to find a nash equalibrium or fail...
 double avgNashIters;
+//! number of objects outside the cluster considered for addition
+double numAddCandidates;
+//! number of those objects skipped because their reward bound was not positive
+double numPruned;
+//! number of those objects skipped because they lie outside the frontier
+double numOffFrontier;
+//! number of deals discarded at commit because their seed was taken by an earlier commit
+double numConflicts;
+//! number of deals in jacobi mode that oscillated and were finished one domain at a time
+double numOscillations;
+//! the whole domain is scored in one pass unless fewer than 1/BULK_RATIO of its objects survive pruning
+static const int BULK_RATIO=4;
+//! least number of candidates per chunk when scoring in parallel
+static const int PARALLEL_GRAIN=256;
+//! number of seeds the pipeline sampler draws ahead of the deal threads
+static const int PIPELINE_PREFETCH=4;
 
 
 /////////////////////////REWARD FUNCTIONS///////////////////////////////////////
@@ -162,28 +389,62 @@ void UpdateTired(NCluster *c);
 
 
 /*!
- Returns the set of objects not currently in the cluster whose addition increases the reward function for the specified domain
-    \param a the current cluster
+ Computes the set of objects not currently in the cluster whose addition increases the reward function for the specified domain
+ Returns true if the set is not empty. With overlap counters, and if Reward::ZeroOverlapBound is
+ at most 0 so that no object sharing nothing with the cluster can be added, only the frontier of the
+ domain (ClusterView::GetFrontier) is considered (asserted when the whole domain is scored), otherwise objects whose reward bound
+ (Reward::Bounds) is not positive are skipped. When few objects remain they are scored one by
+ one, otherwise the whole domain is scored in one pass with Reward::Scores
+    \param a view of the current cluster
     \param domain the domain for which possible addtions are computed
-    \param RewardFunc pointer to the reward function to be used
+    \param add receives the objects, previous contents are removed
+    \tparam Reward the reward policy, e.g. SimpleWeightedReward
  */
-
-IOSet *AddSet_Reward(NCluster *a, int domain);
+template<class Reward>
+bool AddSet_Reward(ClusterView *a, int domain, IOSet *add);
 
 /*!
- Returns the set of objects in the current cluster and specifed domain whose removal increases the reward function
-    \param a the current cluster
+ Computes the set of objects in the current cluster and specifed domain whose removal increases the reward function
+ Returns true if the set is not empty
+    \param a view of the current cluster
     \param domain the domain for which possible addtions are computed
-    \param RewardFunc pointer to the reward function to be used
+    \param remove receives the objects, previous contents are removed
+    \tparam Reward the reward policy, e.g. SimpleWeightedReward
+ */
+template<class Reward>
+bool RemoveSet_Reward(ClusterView *a, int domain, IOSet *remove);
+
+/*!
+ Appends to out the candidates whose score has the given sign, in the order of cands.
+ With scorePool the candidates are split into consecutive chunks of at least
+ PARALLEL_GRAIN objects that are scored in parallel, each into its own buffer of the
+ view; the buffers are then concatenated, so no locks are taken and out stays sorted.
+ Reward::Prepare is called first so that Reward::Score only reads the view.
+    \param a view of the current cluster
+    \param domain the domain of the candidates
+    \param cands sorted candidate objects
+    \param sign 1 to keep positive scores, -1 to keep negative scores
+    \param out receives the objects
+    \tparam Reward the reward policy
  */
-IOSet *RemoveSet_Reward(NCluster *a, int domain);
+template<class Reward>
+void ScoreCandidates(ClusterView *a, int domain, const vector<int> &cands, int sign, IOSet *out);
+
+/*!
+  Returns the sum of the rewards of all objects of c for the domains they are in. The
+  overlaps are counted directly (a ClusterView without OverlapCounts), so the cost is the
+  degree of c and the counters of the deals are left alone.
+    \tparam Reward the reward policy
+ */
+template<class Reward>
+double TotalReward(NCluster *c);
 
 
 ////////////////////////////////////Helper functions////////////////////////////
 /*!
  Randomly select a domain
  */
-int SelectRandomDomain();
+int SelectRandomDomain(Rng &rng);
 
 /*!
  Determine if the selection sets are empty
@@ -192,10 +453,12 @@ bool SelectEmpty(NCluster*);
 /*!
  Randomly select a and object from the set
  */
-int SelectRandomObjectFromSet(IOSet*);
+int SelectRandomObjectFromSet(IOSet*, Rng &rng);
 
 /*!
-  Check if a cluster is a repeat of a previously enumerated cluster
+  Check if a cluster is a repeat of a previously enumerated cluster: one of its sets is
+  empty or equals the set at the same position of a cluster in CONCEPTS. The sets are
+  looked up in repeats. In the top K modes only the clusters kept are compared.
  */
 bool CheckRepeat(NCluster *);
 
@@ -206,10 +469,13 @@ NCluster* MakeInitialSampleSet();
 
 /*!
   Update the set suitable for selection by removing all the elements of
-  the input NCluster
+  the input NCluster. Bumps selectionVersion if selection is the one seeds are drawn from
 */
 
 void UpdateSampleSet(NCluster *selection, NCluster *currCluster, NCluster *clustered);
+
+//! Makes selection the sets seeds are drawn from, with a new selectionVersion
+void SampleFrom(NCluster *selection);
 };
 #endif	/* FRAMEWORK_H */
 
@@ -0,0 +1,75 @@
+/*!
+ Adaptive representation of an object-set. A HybridSet holds the same sorted
+ elements as an IOSet, but chooses between three containers according to the
+ density of the set within its domain (the universe):
+
+    ARRAY  - sorted vector of integers, best for sparse sets
+    BITMAP - one bit per object of the domain, best for dense sets
+    RUN    - sorted list of [start,end] intervals, best for sets made of long
+             consecutive ranges (e.g. all labels of a domain)
+
+ The container is selected by Assign() using the number of bytes each
+ container would occupy. When ClusterView counts overlaps directly (-direct, no
+ OverlapCounts) it keeps a HybridSet of every cluster set and counts the neighbors
+ of an object in it with IntersectCount(), which uses the kernel matching the
+ container, so probing a dense cluster set costs O(|row|) bit tests rather than a
+ merge over both sets. GetBits() gives the bitmap of a set for the dense contexts.
+
+ This is the only place the containers are used. IOSet and the set operations of
+ Ops.h belong to the core library and keep their sorted arrays, and the default
+ reward path reads the overlaps from OverlapCounts without intersecting sets, so
+ there are no mixed container versions of Intersect, Union and Difference.
+
+ \sa IOSet
+ \sa ClusterView
+ */
+
+#ifndef HYBRIDSET_H
+#define	HYBRIDSET_H
+
+#include "core.h"
+#include "SetKernels.h"
+
+using namespace std;
+
+class HybridSet {
+public:
+    //! Default constructor, empty ARRAY container over an empty universe
+    HybridSet();
+
+    //! Assign the sorted elements of a, and select the best container
+    void Assign(IOSet *a, int universe);
+
+    //! Returns |self intersect b| for the sorted array b of nb elements
+    int IntersectCount(const unsigned int *b, int nb);
+    //! fills w (of nwords words) with the bitmap of the current container
+    void GetBits(vector<unsigned long long> &w, int nwords);
+
+    //! sorted array container
+    static const int ARRAY=0;
+    //! bitmap container
+    static const int BITMAP=1;
+    //! run-length container
+    static const int RUN=2;
+
+private:
+    //! number of runs in the sorted array v of n elements
+    static int CountRuns(const unsigned int *v, int n);
+    //! builds the container from the sorted array v of n elements, re-using the memory already held
+    void Build(const unsigned int *v, int n);
+
+    //! container currently in use
+    int type;
+    //! number of elements
+    int size;
+    //! size of the domain the elements are drawn from
+    int universe;
+    //! ARRAY container
+    vector<unsigned int> arr;
+    //! BITMAP container, bit x%64 of word x/64 is set iff x is an element
+    vector<unsigned long long> bits;
+    //! RUN container, inclusive [first,second] intervals in ascending order
+    vector< pair<unsigned int, unsigned int> > runs;
+};
+
+#endif	/* HYBRIDSET_H */
@@ -0,0 +1,85 @@
+/*!
+ Incremental overlap counters for the reward functions of the GHIN framework. For
+ every domain d, every neighbor t of d and every object o of d the counters hold
+ |object-set of o in the context (d,t) intersect C_t|, where C_t is the set of domain t
+ of the candidate n-cluster. When an object x joins or leaves C_t only the counters of
+ the objects related to x change, so an update costs O(degree of x) instead of a
+ recount of every object of every neighboring domain.
+
+ The counters also maintain the frontier of every domain: the objects with at least one
+ related object in the cluster sets of the neighboring domains. Objects outside the
+ frontier overlap with no cluster set at all, and the frontier changes only when a total
+ count moves between 0 and 1, so it is kept up to date at no extra asymptotic cost.
+
+ The counters are meant to be kept for the whole run and Reset() for every deal, so
+ their memory is allocated once. They remember the objects added, and Reset() removes
+ those again before adding the new sets, so a reset costs O(degree of the previous and
+ the new cluster) rather than O(size of the counters).
+
+ The adjacency and the layout of the counters (CsrGraph::GetNeighborIndex) are read from
+ the CsrGraph, which is shared, so every instance only allocates its mutable arrays:
+ (degree(d)+3)*|d| ints for every domain d, plus the frontier and members as they grow.
+ Every deal thread keeps one instance.
+
+ \sa ClusterView
+ \sa CsrContext.h
+ */
+
+#ifndef OVERLAPCOUNTS_H
+#define	OVERLAPCOUNTS_H
+
+#include "CsrContext.h"
+
+using namespace std;
+
+class OverlapCounts {
+public:
+    //! Allocates the counters of every domain pair of hin, all counts are 0
+    /*!
+        \param hin the information network
+        \param csr CSR copy of hin, not copied, it must outlive the counters
+     */
+    OverlapCounts(RelationGraph *hin, CsrGraph *csr);
+
+    //! Sets all counts to the overlaps with the sets in sets (indexed by domain id), sets[0] is ignored
+    void Reset(const vector<IOSet*> &sets);
+    //! Updates the counters after object x joined the set of domain t
+    void Add(int t, unsigned int x);
+    //! Updates the counters after object x left the set of domain t
+    void Remove(int t, unsigned int x);
+    //! Updates the counters after the objects of xs joined the set of domain t
+    void Add(int t, IOSet *xs);
+    //! Updates the counters after the objects of xs left the set of domain t
+    void Remove(int t, IOSet *xs);
+
+    //! Returns |object-set of obj in the context (domain,t) intersect C_t|
+    int Get(int domain, int t, int obj) const { return GetAll(domain,t)[obj]; }
+    //! Returns the counters of all objects of domain with respect to C_t
+    const int *GetAll(int domain, int t) const { return counts[domain].data() + (long)csr->GetNeighborIndex(domain,t)*total[domain].size(); }
+    //! Returns the objects of domain related to at least one object of the cluster sets, in no particular order
+    const vector<int> &GetFrontier(int domain) const { return frontier[domain]; }
+
+private:
+    //! adds delta to the counters of all objects related to x in the neighbors of t
+    void Update(int t, unsigned int x, int delta);
+    //! Update() plus the bookkeeping of the members of C_t
+    void Join(int t, unsigned int x);
+    void Leave(int t, unsigned int x);
+
+    //! CSR copies of the contexts, used for the reverse adjacency
+    CsrGraph *csr;
+    //! counts[d][i*|d| + o], the counters of the objects o of d with respect to C_t of the ith neighbor t of d
+    vector< vector<int> > counts;
+    //! total[d][o], sum of counts[d][t][o] over all t
+    vector< vector<int> > total;
+    //! frontier[d], objects of d with total[d][o] > 0
+    vector< vector<int> > frontier;
+    //! pos[d][o], index of o in frontier[d] or -1
+    vector< vector<int> > pos;
+    //! members[t], objects of C_t counted, in no particular order
+    vector< vector<unsigned int> > members;
+    //! memberPos[t][x], index of x in members[t] or -1
+    vector< vector<int> > memberPos;
+};
+
+#endif	/* OVERLAPCOUNTS_H */
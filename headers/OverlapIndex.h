@@ -0,0 +1,80 @@
+/*!
+ MinHash locality sensitive hashing of n-clusters, to find the clusters that may
+ overlap a new one by more than a threshold without comparing it with all of them.
+
+ The overlap of two n-clusters is the average Jaccard coefficient of their sets
+ (AverageOverlap), so two clusters that overlap by more than t have at least one pair
+ of sets with a Jaccard coefficient above t. Every set is summarized by a MinHash
+ signature of NUM_HASHES minima, which agree for two sets with probability equal to
+ their Jaccard coefficient. The signature is cut into bands of rows minima and every
+ band is hashed into a table of its domain; two sets land in a common bucket with
+ probability 1-(1-J^rows)^bands. The number of rows is chosen as large as possible
+ (so the fewest dissimilar sets collide) while sets with J = t still collide with
+ probability MIN_RECALL. Below a threshold so low that no banding reaches that, the
+ index returns every cluster.
+
+ The candidates are only proposals; the caller verifies them with the exact overlap.
+ A pair above the threshold is missed with probability below 1-MIN_RECALL.
+
+ \sa TopKOverlap.h
+ \sa RepeatIndex.h
+ */
+
+#ifndef OVERLAPINDEX_H
+#define	OVERLAPINDEX_H
+
+#include "core.h"
+#include "RepeatIndex.h"
+#include <unordered_map>
+
+using namespace std;
+
+class OverlapIndex {
+public:
+    //! Index for overlaps above thresh, hashes are drawn from seed
+    OverlapIndex(double thresh, unsigned long long seed=0);
+
+    //! Adds the cluster c under id, ids must be non-negative and unique
+    void Insert(int id, NCluster *c);
+    //! Removes the cluster with id
+    void Remove(int id);
+    //! Gives the cluster with id the id to, which must be unused
+    void Move(int id, int to);
+    //! Writes to out the ids of the clusters that may overlap c by more than the threshold, each once
+    void Candidates(NCluster *c, vector<int> &out);
+    //! Removes all clusters
+    void Clear();
+
+    //! Returns the number of clusters in the index
+    int Size() const { return keys.size(); }
+    //! Returns the overlap threshold
+    double GetThreshold() const { return thresh; }
+    //! Returns the number of minima per band, 0 if the index returns every cluster
+    int GetRows() const { return rows; }
+
+    //! number of minima in the signature of a set
+    static const int NUM_HASHES=128;
+    //! least probability that two sets with Jaccard coefficient equal to the threshold share a bucket
+    static const double MIN_RECALL;
+
+private:
+    typedef unordered_map<unsigned long long, vector<int> > Buckets;
+    //! writes the band keys of every set of c to out, bands keys per set
+    void BandKeys(NCluster *c, vector<unsigned long long> &out);
+
+    double thresh;
+    int rows;
+    int bands;
+    //! seed of every hash function of the signature
+    vector<unsigned long long> hashSeeds;
+    //! bucket tables, band b of domain position d is table d*bands+b
+    vector<Buckets> tables;
+    //! band keys of every indexed cluster, in the order of tables
+    unordered_map<int, vector<unsigned long long> > keys;
+    //! minima of the set being hashed
+    vector<unsigned long long> minima;
+    //! ids already proposed by Candidates, reset after every call
+    vector<int> seen;
+};
+
+#endif	/* OVERLAPINDEX_H */
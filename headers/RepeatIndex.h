@@ -0,0 +1,73 @@
+/*!
+ Hash index of the sets of the clusters found by the GHIN framework, so that
+ Ghin::CheckRepeat no longer compares a new cluster with every stored one. A cluster
+ repeats an earlier one if any of its sets equals the set at the same position of an
+ earlier cluster; the index therefore keys every set by its position and a 128 bit
+ fingerprint of its elements. A lookup hashes each set of the new cluster once and
+ compares elements only with the sets whose fingerprint matches, which for distinct
+ sets is almost never.
+
+ The index refers to the clusters by their address; a cluster must stay unchanged
+ while it is indexed and be removed before it is deleted.
+
+ \sa Framework.h
+ */
+
+#ifndef REPEATINDEX_H
+#define	REPEATINDEX_H
+
+#include "core.h"
+#include <unordered_map>
+
+using namespace std;
+
+//! 128 bit fingerprint of the elements of a set
+struct SetFingerprint {
+    unsigned long long lo;
+    unsigned long long hi;
+    bool operator==(const SetFingerprint &b) const { return lo == b.lo && hi == b.hi; }
+};
+
+//! Hash of a fingerprint for unordered containers, the fingerprint is already mixed
+struct SetFingerprintHash {
+    size_t operator()(const SetFingerprint &f) const { return (size_t)(f.lo ^ f.hi); }
+};
+
+//! Returns the fingerprint of the elements of a
+SetFingerprint FingerprintSet(IOSet *a);
+
+//! 64 bit finalizer of splitmix64, also used by the hashes of OverlapIndex
+inline unsigned long long Mix64(unsigned long long x){
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+class RepeatIndex {
+public:
+    //! Empty index
+    RepeatIndex();
+
+    //! Adds the sets of c
+    void Add(NCluster *c);
+    //! Removes the sets of c, which must have been added
+    void Remove(NCluster *c);
+    //! Returns true if some set of a equals the set at the same position of an indexed cluster
+    bool FindSet(NCluster *a);
+    //! Returns the number of indexed clusters
+    int Size() const { return indexed; }
+    //! Removes all clusters
+    void Clear();
+
+private:
+    typedef unordered_map<SetFingerprint, vector<NCluster*>, SetFingerprintHash> SetMap;
+    //! for every position, the clusters whose set at that position has a fingerprint
+    vector<SetMap> byPosition;
+    //! number of clusters indexed
+    int indexed;
+};
+
+#endif	/* REPEATINDEX_H */
@@ -0,0 +1,81 @@
+/*!
+ Counter-based random number generation for the GHIN framework. An Rng is the
+ Philox4x32-10 generator of Salmon et al. ("Parallel random numbers: as easy as
+ 1, 2, 3", SC 2011): the output is a keyed bijection of a 128 bit counter, so a
+ generator is just a key and a position. The key is the seed of the run, and half
+ of the counter selects a stream, so every stream is independent of every other
+ and can be started anywhere in O(1) without stepping through the ones before it.
+
+ The framework gives every iteration of the algorithm its own streams (see
+ Ghin::SAMPLE_STREAM and Ghin::DEAL_STREAM), so the random choices of a seed draw
+ or a deal depend only on the seed of the run and the number of the iteration,
+ whichever thread runs it.
+
+ The draws of the core library (WeightedUniformDraw, UniformSubsetDraw and
+ BinomialSubsetDraw) use the global rand(); the functions below are the same draws
+ taking an Rng.
+
+ \sa Framework.h
+ \sa random_sample.h
+ */
+
+#ifndef RNG_H
+#define	RNG_H
+
+#include "core.h"
+
+using namespace std;
+
+class Rng {
+public:
+    //! Stream number stream of the generator keyed by seed
+    Rng(unsigned long long seed=0, unsigned long long stream=0);
+
+    //! Restarts the generator at the beginning of stream number stream of seed
+    void Seed(unsigned long long seed, unsigned long long stream);
+    //! Returns the next 32 random bits
+    unsigned int Next32(){
+        if (pos == 4)
+            Refill();
+        return out[pos++];
+    }
+    //! Returns the next 64 random bits
+    unsigned long long Next64(){
+        unsigned long long hi = Next32();
+        return (hi << 32) | Next32();
+    }
+    //! Returns a uniform double in [0,1) with 53 random bits
+    double Uniform(){ return (Next64() >> 11) * (1.0/9007199254740992.0); }
+    //! Returns a uniform integer in [0,n), n > 0, without modulo bias
+    int Below(int n);
+    //! Randomly permutes [first,last), every permutation is equally likely
+    template<class It>
+    void Shuffle(It first, It last){
+        for(long i = (last-first)-1; i > 0; i--)
+            swap(first[i], first[Below(i+1)]);
+    }
+
+private:
+    //! computes the block of the current counter into out and advances the counter
+    void Refill();
+
+    //! key, the seed
+    unsigned int key[2];
+    //! counter, ctr[0..1] is the block number and ctr[2..3] the stream
+    unsigned int ctr[4];
+    //! current block of output
+    unsigned int out[4];
+    //! next unused word of out
+    int pos;
+};
+
+//! Same as WeightedUniformDraw: index i with probability weights[i], the weights sum to 1
+int WeightedUniformDraw(Rng &rng, vector<long double> &weights);
+
+//! Same as UniformSubsetDraw: a subset of t, every subset equally likely
+IOSet *UniformSubsetDraw(Rng &rng, IOSet *t);
+
+//! Same as BinomialSubsetDraw: a subset of t with probability proportional to its size
+IOSet *BinomialSubsetDraw(Rng &rng, IOSet *t);
+
+#endif	/* RNG_H */
@@ -0,0 +1,147 @@
+/*!
+ Low level kernels for operations on sorted arrays of distinct unsigned integers,
+ i.e. the contents of an IOSet. Each kernel has a scalar implementation and
+ SSE4.2, AVX2 and AVX-512 implementations that compare blocks of 4, 8 or 16
+ elements at a time. The widest implementation supported by the cpu is selected
+ at run time. When one input is much smaller than the other the kernels switch
+ to galloping (exponential) search over the larger input. BitAndCount() is the
+ bitmap counterpart of SortedIntersectCount().
+
+ All implementations produce exactly the same output as a scalar merge.
+
+ The IOSet versions at the bottom of this file (SetKernelsIOSet.cpp) are drop in
+ replacements for Intersect(), Difference() and Union() of Ops.h. When only the
+ size of a result is needed use IntersectCount(), which never materializes the
+ result. The versions that take an output IOSet (or work in place) re-use the
+ memory already held by the output, so loops that keep their sets around do not
+ allocate once warmed up.
+
+ The IOSet versions count their operations per thread rather than in numIntersection,
+ numUnion and numDifference of Ops.h, which the core library updates without
+ synchronization, so they may run in several threads. CollectOpCounts() adds the counts
+ to the library counters once the threads are done.
+
+ \sa Ops.h
+ */
+
+#ifndef SETKERNELS_H
+#define	SETKERNELS_H
+
+#include "core.h"
+
+using namespace std;
+
+//! scalar kernels
+const int KERNEL_SCALAR=0;
+//! 128 bit kernels
+const int KERNEL_SSE42=1;
+//! 256 bit kernels
+const int KERNEL_AVX2=2;
+//! 512 bit kernels
+const int KERNEL_AVX512=3;
+
+//! Extra elements that output buffers of the kernels must be able to hold beyond the result size
+const int KERNEL_SLACK=16;
+
+//! Returns the widest kernel level supported by the cpu
+int DetectKernelLevel();
+
+//! Returns the kernel level currently used
+int GetKernelLevel();
+
+//! Force the kernel level, levels above DetectKernelLevel() are lowered to it
+void SetKernelLevel(int level);
+
+//! Returns a printable name for a kernel level
+const char *KernelLevelName(int level);
+
+//! Writes a intersect b to out and returns the number of elements written
+/*!
+    \param a sorted array of na distinct elements
+    \param b sorted array of nb distinct elements
+    \param out must hold at least min(na,nb)+KERNEL_SLACK elements
+ */
+int SortedIntersect(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out);
+
+//! Writes a - b to out and returns the number of elements written
+/*!
+    \param a sorted array of na distinct elements
+    \param b sorted array of nb distinct elements
+    \param out must hold at least na+KERNEL_SLACK elements
+ */
+int SortedDifference(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out);
+
+//! Returns |a intersect b| without writing the intersection
+/*!
+    \param a sorted array of na distinct elements
+    \param b sorted array of nb distinct elements
+ */
+int SortedIntersectCount(const unsigned int *a, int na, const unsigned int *b, int nb);
+
+//! Writes a union b to out and returns the number of elements written
+/*!
+    \param a sorted array of na distinct elements
+    \param b sorted array of nb distinct elements
+    \param out must hold at least na+nb elements
+ */
+int SortedUnion(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out);
+
+//! Returns the number of bits set in both a and b
+/*!
+    \param a bitmap of nwords 64 bit words
+    \param b bitmap of nwords 64 bit words
+ */
+int BitAndCount(const unsigned long long *a, const unsigned long long *b, int nwords);
+
+//! Set intersection using the selected kernel, same result as Intersect() of Ops.h
+IOSet *IntersectFast(IOSet *a, IOSet *b);
+
+//! Returns |a intersect b|, same as Intersect(a,b)->Size() but nothing is allocated
+int IntersectCount(IOSet *a, IOSet *b);
+
+//! Assigns a intersect b to out, the id of out is not changed. out may be a or b
+void Intersect(IOSet *a, IOSet *b, IOSet *out);
+
+//! Assigns a - b to out, the id of out is not changed. out may be a or b
+void Difference(IOSet *a, IOSet *b, IOSet *out);
+
+//! Assigns a union b to out, the id of out is not changed. out may be a or b
+void Union(IOSet *a, IOSet *b, IOSet *out);
+
+//! Removes the elements of b from a, a = a - b
+void DifferenceInPlace(IOSet *a, IOSet *b);
+
+//! Adds the elements of b to a, a = a union b
+void UnionInPlace(IOSet *a, IOSet *b);
+
+//! Prime() of LatticeOps.h computed with the kernels of this file
+/*!
+    Returns the intersection of the object-sets of the objects of a(s) in the context (s,t),
+    NULL if a(s) is empty or the result has fewer than min objects. Unlike Prime() it does
+    not touch the counters of the core library, so it may run in several threads.
+    \param a the n-cluster that contains set s
+    \param g the relation graph in which (s,t) must be an edge
+    \param s source domain id
+    \param t target domain id, the id of the result
+    \param min minimum size of the result
+ */
+IOSet *PrimeFast(NCluster *a, RelationGraph *g, int s, int t, int min);
+
+//! Adds the operations counted by the functions of this file to numIntersection, numUnion and numDifference
+/*!
+    Takes the counts of the calling thread and of all threads that have ended, and clears them.
+    Call it when no other thread runs set operations.
+ */
+void CollectOpCounts();
+
+//! number of scratch sets available to each thread
+const int NUM_SCRATCH=4;
+
+//! Returns scratch IOSet number slot (0 <= slot < NUM_SCRATCH) of the calling thread
+/*!
+ The set keeps its capacity between calls, its contents are whatever the last user left.
+ The set is owned by the thread and must not be deleted.
+ */
+IOSet *ScratchSet(int slot);
+
+#endif	/* SETKERNELS_H */
@@ -0,0 +1,89 @@
+/*!
+ Top K retention of enumerated clusters with an OverlapIndex, the indexed counterpart
+ of RetainTopK_Overlap (algos_helpers/topk.h). RetainTopK_Overlap compares a new
+ cluster with every retained one; here only the clusters the index proposes are
+ compared, so an enumerator keeping a large K no longer pays for K overlaps per
+ cluster. The cluster of lowest quality, which a new cluster overlapping none
+ replaces, is found with a QualityHeap instead of a scan over the K clusters. Usable
+ by any LatticeAlgos enumerator that keeps its top K clusters in a vector, such as
+ CONCEPTS.
+
+ \sa OverlapIndex.h
+ \sa Framework.h
+ */
+
+#ifndef TOPKOVERLAP_H
+#define	TOPKOVERLAP_H
+
+#include "OverlapIndex.h"
+
+using namespace std;
+
+//! Min-heap on quality of the clusters of a top K vector, with their positions in the vector
+/*!
+    Clusters that leave the vector are not taken out of the heap: their entries are
+    skipped once they reach the top (lazy deletion), and the heap is rebuilt from the
+    clusters still in the vector when it holds more than twice as many entries. Every
+    entry carries the serial number of its insertion, so an entry of a deleted cluster
+    never matches a later cluster allocated at the same address. Of two clusters of the
+    same quality the one inserted first is the worse.
+ */
+class QualityHeap {
+public:
+    QualityHeap();
+
+    //! Adds cluster c, which is at position i of the vector
+    void Insert(NCluster *c, int i);
+    //! Cluster c left the vector
+    void Remove(NCluster *c);
+    //! Cluster c moved to position i of the vector
+    void Move(NCluster *c, int i);
+    //! Returns the position of the cluster of lowest quality, -1 if there is none
+    int Worst();
+    //! Returns the number of clusters in the vector
+    int Size() const { return live.size(); }
+
+private:
+    struct Entry {
+        double quality;
+        long serial;
+        NCluster *c;
+    };
+    //! heap order, the root is the entry of lowest quality and then of lowest serial
+    static bool Above(const Entry &a, const Entry &b){
+        return a.quality > b.quality || (a.quality == b.quality && a.serial > b.serial);
+    }
+    //! rebuilds heap from the entries of live
+    void Rebuild();
+
+    vector<Entry> heap;
+    //! serial and position of every cluster in the vector
+    unordered_map<NCluster*, pair<long,int> > live;
+    long nextSerial;
+};
+
+//! Retains the top K clusters, keeping only the higher quality one of two overlapping clusters
+/*!
+    Attempts to add the cluster c to v, which happens if
+     no cluster x in v has Ovlp(c,x) > threshold of index and v.size() < k or
+     Quality(c) > min(Quality(x)) for any x in v (c then replaces the minimum)
+         OR
+     Quality(c) > Quality(x) for every x in v with Ovlp(c,x) > threshold (c then replaces them)
+
+     v owns its clusters: c is deleted if it is not added, and every cluster it replaces
+     is deleted, unless dropped is given, then they are appended to it instead. The index
+     and the heap must hold exactly the clusters of v, under their positions in v; they
+     are kept that way. A cluster that is removed may change the position of the last one.
+     The qualities of the clusters must not change while they are in v.
+     \param v the vector of current clusters enumerated by the algorithm
+     \param c the current cluster enumerated
+     \param Ovlp a function pointer to a function that computes overlap between clusters \sa Ops
+     \param index the index of v, built with the overlap threshold
+     \param heap the quality heap of v
+     \param k K
+     \param dropped if not NULL receives the clusters removed from v and c if it is not added
+     \return true if c was added
+ */
+bool RetainTopK_OverlapIndexed(vector<NCluster*> &v, NCluster *c,double (*Ovlp)(NCluster*,NCluster*), OverlapIndex &index, QualityHeap &heap, int k, vector<NCluster*> *dropped=NULL);
+
+#endif	/* TOPKOVERLAP_H */
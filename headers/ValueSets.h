@@ -0,0 +1,125 @@
+/*!
+ Value-semantic counterparts of IOSet and NCluster. Both can be copied, moved and
+ returned by value, and neither requires a separate heap object per set:
+
+   SmallSet    - array of unsigned integers that keeps up to INLINE_CAPACITY
+                 elements inside the object itself, larger arrays move to the heap
+   FlatCluster - n-cluster that keeps the elements of all of its sets in one
+                 contiguous block, with per-set offsets and domain ids
+
+ Moving either type only transfers pointers (or copies the inline elements), so they
+ are meant for handing clusters between stages of an algorithm without deep copies:
+ the threaded algorithms keep the seed of every deal as a FlatCluster until its
+ commit, and the pipeline passes seeds, deals and commits through its queues as
+ FlatClusters.
+
+ That hand-off is their only use. A deal itself (Ghin::MakeDeal) still builds and
+ scores its cluster as an NCluster of IOSets held by a ClusterView, since the prime,
+ sampling and output functions of the core library all take NCluster and IOSet.
+
+ \sa IOSet
+ \sa NCluster
+ */
+
+#ifndef VALUESETS_H
+#define	VALUESETS_H
+
+#include "core.h"
+
+using namespace std;
+
+//! Growable array of unsigned integers that keeps up to INLINE_CAPACITY elements inside the object, the storage of FlatCluster
+class SmallSet {
+public:
+    //! number of elements stored without a heap allocation
+    static const int INLINE_CAPACITY=8;
+
+    //! Default constructor, empty set
+    SmallSet();
+    //! Copy constructor
+    SmallSet(const SmallSet &a);
+    //! Move constructor, a is left empty
+    SmallSet(SmallSet &&a);
+    //! Copy assignment
+    SmallSet &operator=(const SmallSet &a);
+    //! Move assignment, a is left empty
+    SmallSet &operator=(SmallSet &&a);
+    //! Destructor
+    ~SmallSet();
+
+    //! Returns the number of elements
+    int Size() const { return size; }
+    //! Returns the ith element
+    unsigned int At(int i) const { return d[i]; }
+    //! Returns a reference to the ith element
+    unsigned int &operator[](int i) { return d[i]; }
+    //! Returns a pointer to the first element
+    const unsigned int *Begin() const { return d; }
+
+    //! Adds x to the end of the set
+    void Add(unsigned int x);
+    //! Appends the n elements of v
+    void Append(const unsigned int *v, int n);
+    //! Removes all elements, the capacity is kept
+    void Clear();
+    //! Changes the number of elements to n, new elements are not initialized
+    void Resize(int n);
+    //! Makes sure at least n elements can be stored without re-allocation
+    void Reserve(int n);
+
+private:
+    //! Returns true if the elements are stored inside the object
+    bool IsInline() const { return d == local; }
+    //! points to local or to a heap block of capacity elements
+    unsigned int *d;
+    //! number of elements
+    int size;
+    //! number of elements that fit in d
+    int capacity;
+    //! inline storage
+    unsigned int local[INLINE_CAPACITY];
+};
+
+//! n-cluster in one contiguous block, used to hand seeds and deals between threads
+class FlatCluster {
+public:
+    //! Default constructor, n-cluster with no sets
+    FlatCluster();
+    //! Copy of the sets, ids and quality of a
+    explicit FlatCluster(NCluster *a);
+
+    //! Returns n, the number of sets
+    int GetN() const { return ids.Size(); }
+    //! Returns the number of elements of the ith set
+    int GetSetSize(int i) const { return offsets.At(i+1) - offsets.At(i); }
+    //! Returns a pointer to the elements of the ith set
+    const unsigned int *GetSetData(int i) const { return data.Begin() + offsets.At(i); }
+    //! Returns the id of the ith set
+    int GetSetId(int i) const { return ids.At(i); }
+    //! Returns the quality
+    double GetQuality() const { return quality; }
+
+    //! Adds a copy of a
+    void AddSet(IOSet *a);
+    //! Replaces the contents by a copy of a
+    void Assign(NCluster *a);
+    //! Removes all sets
+    void Clear();
+    //! Returns the number of elements the ith set has in common with b
+    int IntersectCount(int i, IOSet *b) const;
+
+    //! Returns a new n-cluster with the sets, ids and quality
+    NCluster *ToNCluster() const;
+
+private:
+    //! elements of all sets, set i occupies [offsets[i], offsets[i+1])
+    SmallSet data;
+    //! start of every set in data, plus the end of the last set
+    SmallSet offsets;
+    //! domain id of every set
+    SmallSet ids;
+    //! quality of the n-cluster
+    double quality;
+};
+
+#endif	/* VALUESETS_H */
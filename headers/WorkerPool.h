@@ -0,0 +1,71 @@
+/*!
+ A fixed set of helper threads for data-parallel loops inside a deal of the GHIN
+ framework. Run() splits a loop into chunks that the calling thread and the helpers
+ take from a shared counter, so uneven chunks balance themselves. The helpers sleep
+ between loops and are kept for the whole run, so a loop costs a wake-up rather than
+ a thread start.
+
+ Only one loop runs on the pool at a time. When the pool is already busy, because
+ several deals run in parallel or because Run() is called from inside a loop, Run()
+ executes all chunks in the calling thread instead of waiting, so a loop never stalls
+ on another loop.
+
+ \sa Framework.h
+ */
+
+#ifndef WORKERPOOL_H
+#define	WORKERPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+using namespace std;
+
+class WorkerPool {
+public:
+    //! Starts numThreads-1 helper threads, the caller of Run() is the last one
+    WorkerPool(int numThreads);
+    //! Stops and joins the helpers
+    ~WorkerPool();
+
+    //! Returns the number of threads working on a loop, including the caller
+    int GetNumThreads() const { return helpers.size()+1; }
+    //! Calls body(chunk) once for every chunk in [0,numChunks) and returns when all calls are done
+    /*!
+        Calls may run concurrently in any order, body must only write state owned by its chunk.
+     */
+    void Run(int numChunks, const function<void(int)> &body);
+
+private:
+    //! loop of a helper thread
+    void Help();
+    //! takes chunks of the current loop until there are none left
+    void Work();
+
+    vector<thread> helpers;
+    //! set while a loop runs, see Run()
+    atomic<bool> busy;
+    //! guards generation, stop and active
+    mutex lock;
+    //! wakes the helpers for a new loop
+    condition_variable wake;
+    //! signals the caller that the helpers are done
+    condition_variable done;
+    //! incremented for every loop
+    long generation;
+    //! set to stop the helpers
+    bool stop;
+    //! number of helpers still working on the current loop
+    int active;
+    //! body and number of chunks of the current loop
+    const function<void(int)> *body;
+    int numChunks;
+    //! next chunk to take
+    atomic<int> next;
+};
+
+#endif	/* WORKERPOOL_H */
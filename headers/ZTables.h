@@ -0,0 +1,82 @@
+/*!
+ Tables of the expected value and standard deviation used by the z-score reward functions
+ (See Z_Rewards.h). Within one context the mean and deviation only depend on the degree m
+ of the object, the size n of the cluster set in the other domain and the size NN of that
+ domain. NN is fixed per context and n changes at most once per best-response round, so
+ a ZTable keeps the values for every degree that occurs in the context and is only
+ rebuilt when n changes. The values themselves come from BasicStats, so scores computed
+ from the table are identical to those computed by calling BasicStats per object.
+
+ Accumulate() adds the z-scores of a whole domain in one branch-light pass.
+
+ \sa BasicStats.h
+ \sa Z_Rewards.h
+ */
+
+#ifndef ZTABLES_H
+#define	ZTABLES_H
+
+#include "core.h"
+
+using namespace std;
+
+class ZTable {
+public:
+    //! hypergeometric expectation, Hypgeo_Mean(n,m,NN) and Hypgeo_Dev(n,m,NN)
+    static const int HYPGEO=0;
+    //! beta-binomial expectation with alpha=m+1 and beta=NN-m+1
+    static const int BETABINOMIAL=1;
+
+    //! Empty table
+    ZTable();
+
+    //! Fills the table for the specified distribution, does nothing if it already holds these values
+    /*!
+        \param kind HYPGEO or BETABINOMIAL
+        \param n size of the cluster set of the other domain
+        \param NN number of objects in the other domain
+        \param degrees the degrees that occur in the context, ascending
+     */
+    void Build(int kind, int n, int NN, const vector<int> &degrees);
+
+    //! Returns the expected value for degree m
+    double Mean(int m) const { return mean[m]; }
+    //! Returns the standard deviation for degree m
+    double Dev(int m) const { return dev[m]; }
+    //! Returns the z-score of x for degree m, same value as Z_Score(x,Mean(m),Dev(m))
+    double Z(double x, int m) const {
+        return dev[m] != 0 ? (x - mean[m]) / dev[m] : Z_Score(x,mean[m],dev[m]);
+    }
+
+    //! Returns the largest Z(0,m) over the degrees of the context, the z-score of an object sharing nothing with the cluster set
+    /*!
+        At most 0 wherever the deviation is not 0, since the mean is never negative; a zero
+        deviation is left to Z_Score
+     */
+    double ZeroZ() const { return zeroZ; }
+
+    //! scores[i] += Z(ones[i],degrees[i]) - w for 0 <= i < count
+    void Accumulate(const int *ones, const int *degrees, int count, double w, double *scores) const;
+    //! bounds[i] += an upper bound of Z(ones,degrees[i]) - w over all ones <= min(degrees[i],n)
+    /*!
+        The bound is the z-score of min(degrees[i],n) since the z-score grows with the number of
+        ones, or HUGE_VAL when the deviation is 0 and the z-score is left to Z_Score.
+     */
+    void AccumulateBound(const int *degrees, int count, double w, double *bounds) const;
+
+private:
+    //! distribution of the table, -1 while empty
+    int kind;
+    //! n the table was built for
+    int n;
+    //! NN the table was built for
+    int NN;
+    //! mean indexed by degree
+    vector<double> mean;
+    //! standard deviation indexed by degree
+    vector<double> dev;
+    //! see ZeroZ
+    double zeroZ;
+};
+
+#endif	/* ZTABLES_H */
@@ -13,31 +13,127 @@
 #define	Z_REWARDS_H
 
 #include "core.h"
+#include "ClusterView.h"
+#include "ZTables.h"
 #include "Framework.h"
 
 
 /*!
-  Computes the expected satasfaction score using hypogemoteric distribution. \
-  See Alqadah et al. in KDD '11 for details
- \params a the ncluster to compute score for
- \param obj the object id to compute for
- \param doamin the domain id for which to compute the score with respect to
- \param w the weight paramater (see Alqadah et al. KDD 2011)
- \param hin the information network
+ Reward policy of the expected satisfaction scores. KIND selects the distribution of the
+ expected number of interactions, ZTable::HYPGEO or ZTable::BETABINOMIAL (alpha = m+1,
+ beta = NN-m+1). The scoring code is inline so that the deal steps instantiated for this
+ policy (see Ghin::AddSet_Reward) can inline it.
  */
-double Exp_Sat_HypGeo_Score(NCluster *a, int obj, int domain, double w, RelationGraph *hin);
+template<int KIND>
+struct ExpSatReward {
+    /*!
+     Computes the expected satasfaction score. See Alqadah et al. in KDD '11 for details
+     \param a view of the ncluster to compute score for
+     \param obj the object id to compute for
+     \param domain the domain id for which to compute the score with respect to
+     \param w the weight paramater (see Alqadah et al. KDD 2011)
+     \param hin the information network
+     */
+    static inline double Score(ClusterView *a, int obj, int domain, double w, RelationGraph *hin){
+        const vector<int> &neighbors = a->GetCsr()->GetNeighbors(domain);
+        const vector<CsrContext*> &contexts = a->GetCsr()->GetContexts(domain);
+        double score = 0.0;
+        for(int i=0; i < neighbors.size(); i++){
+            double B= a->GetSetById( neighbors[i])->Size() ;
+            if(B > 0){
+                CsrContext *currContext = contexts[i];
+                int n = a->GetSetById( neighbors[i] )->Size();
+                int m = currContext->GetDegree(domain,obj);
+                int NN =currContext->GetNumSets(neighbors[i]);
+                ZTable *table = a->GetZTable(domain,neighbors[i]);
+                table->Build(KIND,n,NN,currContext->GetDistinctDegrees(domain));
+                double ones = a->Overlap(currContext,domain,obj,neighbors[i]);
+                double tfactor = 1.0;///pow(tired[domain][obj],1.5);
+                double zscore = table->Z(ones,m);
+                double z = tfactor*zscore-w;
+                score += z;
+            }
+        }
+        return score;
+    }
 
+    //! Computes Score for every object of domain in one pass over the domain, the score of object i at index i of scores
+    static inline void Scores(ClusterView *a, int domain, double w, RelationGraph *hin, vector<double> &scores){
+        const vector<int> &neighbors = a->GetCsr()->GetNeighbors(domain);
+        const vector<CsrContext*> &contexts = a->GetCsr()->GetContexts(domain);
+        int numObjs = hin->NumObjsInDomain(domain);
+        scores.assign(numObjs,0.0);
+        for(int i=0; i < neighbors.size(); i++){
+            double B= a->GetSetById( neighbors[i])->Size() ;
+            if(B > 0){
+                CsrContext *currContext = contexts[i];
+                const int *ones = a->Overlaps(currContext,domain,neighbors[i]);
+                int n = a->GetSetById( neighbors[i] )->Size();
+                int NN =currContext->GetNumSets(neighbors[i]);
+                ZTable *table = a->GetZTable(domain,neighbors[i]);
+                table->Build(KIND,n,NN,currContext->GetDistinctDegrees(domain));
+                table->Accumulate(ones,currContext->GetDegrees(domain),numObjs,w,scores.data());
+            }
+        }
+    }
 
+    //! Upper bounds of Score for all objects of domain, from the degrees and set sizes only
+    static inline void Bounds(ClusterView *a, int domain, double w, RelationGraph *hin, vector<double> &bounds){
+        const vector<int> &neighbors = a->GetCsr()->GetNeighbors(domain);
+        const vector<CsrContext*> &contexts = a->GetCsr()->GetContexts(domain);
+        int numObjs = hin->NumObjsInDomain(domain);
+        bounds.assign(numObjs,0.0);
+        for(int i=0; i < neighbors.size(); i++){
+            double B= a->GetSetById( neighbors[i])->Size() ;
+            if(B > 0){
+                CsrContext *currContext = contexts[i];
+                int n = a->GetSetById( neighbors[i] )->Size();
+                int NN =currContext->GetNumSets(neighbors[i]);
+                ZTable *table = a->GetZTable(domain,neighbors[i]);
+                table->Build(KIND,n,NN,currContext->GetDistinctDegrees(domain));
+                table->AccumulateBound(currContext->GetDegrees(domain),numObjs,w,bounds.data());
+            }
+        }
+    }
 
-/*!
-  Computes the expected satasfaction score using the beta-binomial distribution
- \params a the ncluster to compute score for
- \param obj the object id to compute for
- \param doamin the domain id for which to compute the score with respect to
- \param w the weight paramater
- \param hin the information network
- */
-double Exp_Sat_BetaBinomail_Score(NCluster *a, int obj, int domain, double w, RelationGraph *hin);
+    //! Upper bound of Score for the objects of domain that share no object with the cluster in any context
+    /*!
+        Every term is then at most ZeroZ() - w, which is at most -w unless a zero deviation
+        makes Z_Score decide the z-score of 0 ones.
+     */
+    static inline double ZeroOverlapBound(ClusterView *a, int domain, double w, RelationGraph *hin){
+        const vector<int> &neighbors = a->GetCsr()->GetNeighbors(domain);
+        const vector<CsrContext*> &contexts = a->GetCsr()->GetContexts(domain);
+        double bound = 0.0;
+        for(int i=0; i < neighbors.size(); i++){
+            int n = a->GetSetById( neighbors[i] )->Size();
+            if(n > 0){
+                CsrContext *currContext = contexts[i];
+                int NN =currContext->GetNumSets(neighbors[i]);
+                ZTable *table = a->GetZTable(domain,neighbors[i]);
+                table->Build(KIND,n,NN,currContext->GetDistinctDegrees(domain));
+                bound += table->ZeroZ() - w;
+            }
+        }
+        return bound;
+    }
+
+    //! Builds the z-score tables Score reads for domain, so that Score only reads the view and can run in several threads
+    static inline void Prepare(ClusterView *a, int domain, RelationGraph *hin){
+        const vector<int> &neighbors = a->GetCsr()->GetNeighbors(domain);
+        const vector<CsrContext*> &contexts = a->GetCsr()->GetContexts(domain);
+        for(int i=0; i < neighbors.size(); i++){
+            int n = a->GetSetById( neighbors[i] )->Size();
+            if(n > 0)
+                a->GetZTable(domain,neighbors[i])->Build(KIND,n,contexts[i]->GetNumSets(neighbors[i]),contexts[i]->GetDistinctDegrees(domain));
+        }
+    }
+};
+
+//! expected satisfaction with the hypergeometric distribution
+typedef ExpSatReward<ZTable::HYPGEO> HypGeoReward;
+//! expected satisfaction with the beta-binomial distribution
+typedef ExpSatReward<ZTable::BETABINOMIAL> BetaBinomialReward;
 
 
 
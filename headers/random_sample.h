@@ -2,18 +2,31 @@
 /*!
  This is a derived class of LatticeAlgos and implements random sampling of concepts as based on the paper "Direct Local Pattern Sampling by Efficient Two-Step Random procedures"
 
+ The frequency and area weights are powers of 2 of set sizes. They are computed as
+ exponents and normalized in log space (the largest one is factored out), so objects
+ of very high degree do not overflow the sum of the weights.
+
  */
 
 #ifndef _RANDOM_SAMPLE_H
 #define	_RANDOM_SAMPLE_H
 
 #include "core.h"
+#include "SetKernels.h"
+#include "DealPool.h"
+#include "Rng.h"
+#include "AliasTable.h"
 
 
 
 class NClusterRandomSample : public LatticeAlgos{
 public:
-NClusterRandomSample():LatticeAlgos() {};
+NClusterRandomSample():LatticeAlgos() {
+    pool=NULL;
+    rng=NULL;
+    tables=NULL;
+    version=0;
+};
     //! Inteface for  random sampling algorithms for n-clustsers
 
 
@@ -48,7 +61,7 @@ vector<long double> * GetFreqWeightsStar(RelationGraph *g, int s);
 /*!
     \param g the hin
     \params s domain id of the central node
- *
+ *  Returns NULL if all weights are 0
  */
 vector<long double> * GetFreqWeightsStar(RelationGraph *g, int s, NCluster *subSets);
 
@@ -114,10 +127,40 @@ NCluster* SubspaceStarShapedArea(RelationGraph *g, int s );
 NCluster * SubspaceFreqNetwork(RelationGraph *g, int s,NCluster *subspace);
 
 //! Helper function for SubspaceFreqNetwork sampling that copies sample IOSets into ret and marks those domains in completedDomains
-//! Also adjusts sampleSubpace to reflect sample
+//! Also adjusts sampleSubpace to reflect sample, unless it is NULL
 
 void AdjustSampleSubspace(NCluster *sampleSubspace, NCluster *sample, NCluster *ret, IOSet *completedDomains);
 
+//! if not NULL, temporaries that do not outlive a sampling call are taken from this pool
+DealPool *pool;
+
+//! if not NULL, the random draws are taken from this generator instead of rand()
+Rng *rng;
+
+//! if not NULL, the alias tables of the frequency weights of the subspace passed to SubspaceFreqNetwork are kept here across sampling calls
+AliasCache *tables;
+
+//! version of the subspace passed to SubspaceFreqNetwork, the key of tables; it must change whenever the sets of the subspace do
+long version;
+
+private:
+//! WeightedUniformDraw from rng, or from rand() without rng
+int DrawWeighted(vector<long double> &weights);
+//! UniformSubsetDraw from rng, or from rand() without rng
+IOSet *DrawUniformSubset(IOSet *t);
+//! BinomialSubsetDraw from rng, or from rand() without rng
+IOSet *DrawBinomialSubset(IOSet *t);
+//! Draws from table with rng, or with rand() without rng
+int DrawAlias(const AliasTable &table);
+//! Returns the alias table of GetFreqWeightsStar(g,s,sample), NULL if all weights are 0
+/*!
+    The table is taken from tables if sample is the versioned subspace (cached), and newly built otherwise
+ */
+AliasTable *FreqTableStar(RelationGraph *g, int s, NCluster *sample, bool cached);
+
+//! table built by FreqTableStar without tables
+AliasTable localTable;
+
 };
 #endif	/* _RANDOM_SAMPLE_H */
 
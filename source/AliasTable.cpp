@@ -0,0 +1,83 @@
+#include "../headers/AliasTable.h"
+
+AliasTable::AliasTable(){
+}
+
+bool AliasTable::Build(const vector<long double> &weights){
+    int n = weights.size();
+    prob.clear();
+    alias.clear();
+    long double sum = 0;
+    for(int i=0; i < n; i++) sum += weights[i];
+    if (n == 0 || !(sum > 0))
+        return false;
+    prob.resize(n);
+    alias.resize(n);
+    //columns of height 1: small columns are topped up from large ones
+    vector<long double> scaled(n);
+    vector<int> small, large;
+    for(int i=0; i < n; i++){
+        scaled[i] = weights[i]*n/sum;
+        if (scaled[i] < 1)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+    int lastLarge = large.empty() ? 0 : large.back();
+    while (!small.empty() && !large.empty()){
+        int s = small.back(); small.pop_back();
+        int l = large.back();
+        prob[s] = (double)scaled[s];
+        alias[s] = l;
+        lastLarge = l;
+        scaled[l] -= 1-scaled[s];
+        if (scaled[l] < 1){
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    for(int i=0; i < large.size(); i++){
+        prob[large[i]] = 1;
+        alias[large[i]] = large[i];
+    }
+    //only rounding leaves small columns behind, they are full unless their weight is 0
+    for(int i=0; i < small.size(); i++){
+        prob[small[i]] = weights[small[i]] > 0 ? 1 : 0;
+        alias[small[i]] = weights[small[i]] > 0 ? small[i] : lastLarge;
+    }
+    return true;
+}
+
+int AliasTable::Draw(Rng &rng) const{
+    int i = rng.Below(prob.size());
+    return rng.Uniform() < prob[i] ? i : alias[i];
+}
+
+int AliasTable::Draw(double u) const{
+    //the integer part picks the column, the fraction flips the coin
+    double x = u*prob.size();
+    int i = (int)x;
+    if (i >= prob.size())
+        i = prob.size()-1;
+    return x-i < prob[i] ? i : alias[i];
+}
+
+AliasCache::AliasCache(){
+}
+
+AliasTable *AliasCache::Find(int s, long version){
+    if (s < entries.size() && entries[s].version == version)
+        return &entries[s].table;
+    return NULL;
+}
+
+AliasTable *AliasCache::Store(int s, long version){
+    if (entries.size() <= s){
+        Entry empty;
+        empty.version = -1;
+        entries.resize(s+1,empty);
+    }
+    //versions only grow, so the table being replaced is never needed again
+    entries[s].version = version;
+    return &entries[s].table;
+}
@@ -0,0 +1,65 @@
+#include "../headers/ClusterView.h"
+
+ClusterView::ClusterView(NCluster *a, RelationGraph *hin, CsrGraph *csr, OverlapCounts *counts){
+    c = a;
+    this->hin = hin;
+    this->csr = csr;
+    this->counts = counts;
+    sets.assign(hin->GetNumNodes()+1,(IOSet*)NULL);
+    for(int i=1; i < hin->GetNumNodes()+1; i++) sets[i] = a->GetSetById(i);
+    ztables.assign(hin->GetNumNodes()+1, vector<ZTable>(hin->GetNumNodes()+1));
+    scratch.resize(hin->GetNumNodes()+1);
+    if (counts != NULL){
+        counts->Reset(sets);
+        return;
+    }
+    hsets.resize(hin->GetNumNodes()+1);
+    if (csr->HasDense())
+        masks.resize(hin->GetNumNodes()+1);
+    for(int i=1; i < hin->GetNumNodes()+1; i++) Refresh(i);
+}
+
+void ClusterView::Add(int domain, IOSet *delta){
+    UnionInPlace(sets[domain],delta);
+    if (counts != NULL)
+        counts->Add(domain,delta);
+    else
+        Refresh(domain);
+}
+
+void ClusterView::Remove(int domain, IOSet *delta){
+    DifferenceInPlace(sets[domain],delta);
+    if (counts != NULL)
+        counts->Remove(domain,delta);
+    else
+        Refresh(domain);
+}
+
+void ClusterView::Refresh(int domain){
+    if (counts != NULL)
+        return;
+    hsets[domain].Assign(sets[domain], hin->NumObjsInDomain(domain));
+    if (!masks.empty())
+        hsets[domain].GetBits(masks[domain], (hin->NumObjsInDomain(domain)+63)/64+1);
+}
+
+const int *ClusterView::Overlaps(CsrContext *ctx, int domain, int t){
+    if (counts != NULL)
+        return counts->GetAll(domain,t);
+    //scatter the object-sets of the members of C_t over the objects of domain
+    vector<int> &bulk = scratch[domain].bulk;
+    bulk.assign(ctx->GetNumSets(domain)+1,0);
+    int *c = bulk.data();
+    IOSet *ct = sets[t];
+    for(int i=0; i < ct->Size(); i++){
+        SetSpan row = ctx->GetSet(t,ct->At(i));
+        for(int j=0; j < row.size; j++) c[row.data[j]]++;
+    }
+    return c;
+}
+
+DealStats ClusterView::GetStats() const{
+    DealStats total;
+    for(int d=1; d < scratch.size(); d++) total.Add(scratch[d].stats);
+    return total;
+}
@@ -0,0 +1,96 @@
+#include "../headers/CsrContext.h"
+
+CsrContext::CsrContext(Context *c){
+    ctx = c;
+    dense = false;
+    pair<int,int> ids = c->GetDomainIds();
+    d1 = ids.first;
+    d2 = ids.second;
+    Build(c,d1,s1);
+    Build(c,d2,s2);
+}
+
+void CsrContext::Build(Context *c, int domain, Side &sd){
+    int n = c->GetNumSets(domain);
+    sd.offsets.resize(n+1);
+    sd.offsets[0] = 0;
+    for(int i=0; i < n; i++) sd.offsets[i+1] = sd.offsets[i] + c->GetSet(domain,i)->Size();
+    sd.adj.resize(sd.offsets[n]+1);
+    for(int i=0; i < n; i++){
+        IOSet *curr = c->GetSet(domain,i);
+        if (curr->Size() > 0)
+            copy(curr->GetBegin(), curr->GetBegin()+curr->Size(), sd.adj.begin()+sd.offsets[i]);
+    }
+    sd.adj[sd.offsets[n]] = 0;
+    sd.words = 0;
+    sd.degrees.resize(n+1);
+    for(int i=0; i < n; i++) sd.degrees[i] = sd.offsets[i+1] - sd.offsets[i];
+    sd.degrees[n] = 0;
+    sd.distinct.assign(sd.degrees.begin(), sd.degrees.begin()+n);
+    sort(sd.distinct.begin(),sd.distinct.end());
+    sd.distinct.erase(unique(sd.distinct.begin(),sd.distinct.end()),sd.distinct.end());
+}
+
+void CsrContext::BuildBits(Side &sd, int numCols){
+    int n = sd.offsets.size()-1;
+    sd.words = (numCols+63)/64;
+    sd.bits.assign((long)n*sd.words+1, 0ULL);
+    for(int i=0; i < n; i++){
+        unsigned long long *row = &sd.bits[0] + (long)i*sd.words;
+        for(unsigned int j=sd.offsets[i]; j < sd.offsets[i+1]; j++)
+            row[sd.adj[j] >> 6] |= 1ULL << (sd.adj[j] & 63);
+    }
+}
+
+void CsrContext::MakeDense(){
+    if (dense)
+        return;
+    BuildBits(s1,GetNumSets(d2));
+    BuildBits(s2,GetNumSets(d1));
+    dense = true;
+}
+
+double CsrContext::GetDensity() const{
+    double cells = (double)GetNumSets(d1)*(double)GetNumSets(d2);
+    return cells > 0 ? GetNumOnes() / cells : 0.0;
+}
+
+const double CsrGraph::DENSE_THRESHOLD=0.10;
+
+CsrGraph::CsrGraph(RelationGraph *hin, int denseMode){
+    numDense = 0;
+    int n = hin->GetNumNodes();
+    table.assign(n+1, vector<CsrContext*>(n+1,(CsrContext*)NULL));
+    for(int d=1; d < n+1; d++){
+        vector<Context*> *curr = hin->GetContexts(d);
+        for(int i=0; i < curr->size(); i++){
+            pair<int,int> ids = (*curr)[i]->GetDomainIds();
+            if (table[ids.first][ids.second] != NULL)
+                continue;
+            CsrContext *c = new CsrContext((*curr)[i]);
+            if (denseMode == DENSE_ALL || (denseMode == DENSE_AUTO && c->GetDensity() > DENSE_THRESHOLD)){
+                c->MakeDense();
+                numDense++;
+            }
+            all.push_back(c);
+            table[ids.first][ids.second] = c;
+            table[ids.second][ids.first] = c;
+        }
+    }
+    neighbors.resize(n+1);
+    contexts.resize(n+1);
+    slot.assign(n+1, vector<int>(n+1,-1));
+    for(int d=1; d < n+1; d++){
+        IOSet *curr = hin->GetNeighbors(d);
+        for(int i=0; i < curr->Size(); i++){
+            slot[d][curr->At(i)] = neighbors[d].size();
+            neighbors[d].push_back(curr->At(i));
+            contexts[d].push_back(table[d][curr->At(i)]);
+        }
+        delete curr;
+    }
+}
+
+CsrGraph::~CsrGraph(){
+    for(int i=0; i < all.size(); i++) delete all[i];
+}
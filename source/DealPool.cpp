@@ -0,0 +1,30 @@
+#include "../headers/DealPool.h"
+
+DealPool::DealPool(){
+    clustersUsed=0;
+}
+
+DealPool::~DealPool(){
+    DstryVector(clusters);
+}
+
+NCluster *DealPool::CopyCluster(NCluster *a){
+    if (clustersUsed == clusters.size()) clusters.push_back(new NCluster);
+    NCluster *ret = clusters[clustersUsed++];
+    int n = a->GetN();
+    while (ret->GetN() < n) ret->AddSet(new IOSet);
+    while (ret->GetN() > n) ret->RemoveSet(ret->GetN()-1);
+    for(int i=0; i < n; i++){
+        ret->GetSet(i)->Clear();
+        ret->GetSet(i)->DeepCopy(a->GetSet(i));
+        ret->GetSet(i)->SetId(a->GetSet(i)->Id());
+    }
+    ret->SetQuality(a->GetQuality());
+    ret->SetId(a->GetId());
+    ret->SetMarked(false);
+    return ret;
+}
+
+void DealPool::Reset(){
+    clustersUsed=0;
+}
@@ -1,9 +1,15 @@
 #include "../headers/Framework.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <map>
+#include <climits>
+#include <cassert>
 
 
-NCluster* Ghin::SelectInit(int domain, NCluster *sampleSet, NCluster *clustered){
+NCluster* Ghin::SelectInit(int domain, NCluster *sampleSet, NCluster *clustered, Rng &rng){
    // cout<<"\nsample set: \n"; sampleSet->Output(); cout.flush();
-    int obj = SelectRandomObjectFromSet(sampleSet->GetSetById(domain));
+    int obj = SelectRandomObjectFromSet(sampleSet->GetSetById(domain),rng);
     if(obj == -1) //no more objects
         return NULL;
     NCluster *init = new NCluster(hin->GetNumNodes());
@@ -13,7 +19,7 @@ NCluster* Ghin::SelectInit(int domain, NCluster *sampleSet, NCluster *clustered)
     init->GetSetById(domain)->Add(obj);
     //form concept with this object from a random neighbor in the HIN
     IOSet *neighbors = hin->GetNeighbors(domain);
-    int neighborDomain = neighbors->At( rand() % neighbors->Size());
+    int neighborDomain = neighbors->At( rng.Below(neighbors->Size()));
     Context *ctx = hin->GetContext(domain,neighborDomain);
     IOSet *a =  Prime(init,hin,domain,neighborDomain,1);
     if ( a != NULL){
@@ -41,16 +47,22 @@ NCluster* Ghin::SelectInit(int domain, NCluster *sampleSet, NCluster *clustered)
         return NULL;
     }
 }
-NCluster* Ghin::SelectInit_RandomFreq(NCluster *sampleSet){
+NCluster* Ghin::SelectInit_RandomFreq(NCluster *sampleSet, DealPool *pool, Rng &rng){
     IOSet *artDomains = hin->GetArtDomains();
     int s;
     if(artDomains->Size() == 0){
-        s = 1+ rand() % 2; //no articulation domains it is a single context, randomly select
+        s = 1+ rng.Below(2); //no articulation domains it is a single context, randomly select
     }else
-        s = SelectRandomObjectFromSet(artDomains);
+        s = SelectRandomObjectFromSet(artDomains,rng);
     //cout<<"\ns: "<<s;
    // cout.flush();
     NClusterRandomSample sampler;
+    sampler.pool = pool;
+    sampler.rng = &rng;
+    if (sampleSet == sampledSelection){
+        sampler.tables = &sampleTables;
+        sampler.version = selectionVersion;
+    }
     NCluster *ret;
     ret = sampler.SubspaceFreqNetwork(hin,s,sampleSet);
 
@@ -59,7 +71,7 @@ NCluster* Ghin::SelectInit_RandomFreq(NCluster *sampleSet){
 
 }
 
-NCluster* Ghin::MakeDeal(NCluster *candidate){
+NCluster* Ghin::MakeDeal(NCluster *candidate, OverlapCounts *counts, DealStats *stats, Rng &rng){
     int N = hin->GetNumNodes();
     int max_iters = 50;
     int cnt=0;
@@ -68,15 +80,20 @@ NCluster* Ghin::MakeDeal(NCluster *candidate){
     vector<int> order(N);
     for(int i=0; i < N; i++) order[i] =i+1;
     //clear
-    random_shuffle(order.begin(),order.end());
+    rng.Shuffle(order.begin(),order.end());
     int no_change_cnt=0;
 
     //tracking variabled delete later
     int num_add_iters=0;
     int num_remove_iters=0;
     /////////done tracking/////////////
+    ClusterView view(candidate,hin,csr,counts);
+    //jacobi mode: one delta per domain and the fingerprints of the states reached so far
+    vector<IOSet> deltas(jacobiMode ? N+1 : 0);
+    vector<unsigned long long> states;
+    bool oscillating = false;
+    int oscillations = 0;
     while (no_change_cnt < 2 && cnt < max_iters ){
-        vector<IOSet*> changedSets(N+1);
         change=false;
         //randomize the order of deal making
        // cout<<"\ncandidate: \n"; candidate->Output(); cout.flush();
@@ -87,19 +104,23 @@ NCluster* Ghin::MakeDeal(NCluster *candidate){
                 num_remove_iters++;
             //////////done tracking//////////
 
-        for(int i=0; i < N; i++){
-            
-            changedSets[order[i]] = new IOSet(candidate->GetSetById(order[i]));
-            bool currChange = MaximizeDomain(candidate,changedSets[order[i]],order[i],add);
-            change = change || currChange;
+        if (jacobiMode && !oscillating){
+            change = MaximizeAll(&view,add,deltas);
+            //simultaneous updates can cycle through the same states forever, continue
+            //one domain at a time once a change restores an earlier state
+            unsigned long long state = Fingerprint(candidate);
+            if (change && find(states.begin(),states.end(),state) != states.end()){
+                oscillating = true;
+                oscillations++;
+            }
+            states.push_back(state);
+        }else{
+            for(int i=0; i < N; i++){
+                bool currChange = MaximizeDomain(&view,order[i],add);
+                change = change || currChange;
+            }
         }
        // cout<<"\ncandidate: \n"; candidate->Output(); cout.flush();
-        //destroy the vector
-        for(int i=0; i < N; i++) {
-            delete changedSets[i];
-            changedSets[i] = NULL;
-        }
-        avgNashIters++;
         if(change) no_change_cnt=0;
         else no_change_cnt++;
         if(add && !change) add = false;  //cannot add anymore
@@ -108,47 +129,72 @@ NCluster* Ghin::MakeDeal(NCluster *candidate){
         else if (!add && change) add=false; //can maybe still remove move
         cnt++;
     }
-    NCluster *ret = new NCluster(N);
-    ret->DeepCopy(*candidate);
+    DealStats total = view.GetStats();
+    total.nashIters += cnt;
+    total.oscillations += oscillations;
+    stats->Add(total);
+    //the candidate already holds the result, hand it back instead of copying it
     if(no_change_cnt > 1 && cnt < max_iters){
        // cout<<"\nadd iters: "<<num_add_iters;
       //  cout<<"\nremove iters: "<<num_remove_iters;
-        ret->SetQuality(1.0);
+        candidate->SetQuality(1.0);
     }else{
-        ret->SetQuality(0.0);
+        candidate->SetQuality(0.0);
     }
-    return ret;
+    return candidate;
 }
 
-bool Ghin::MaximizeDomain(NCluster *a, IOSet *c, int domain,bool add ){
-    bool ret=false;
+bool Ghin::MaximizeAll(ClusterView *a, bool add, vector<IOSet> &deltas){
+    int N = hin->GetNumNodes();
+    bool (Ghin::*step)(ClusterView*,int,IOSet*) = add ? reward->addSet : reward->removeSet;
+    //every domain answers the same state, so the steps are independent
+    vector<char> changed(N+1,0);
+    function<void(int)> body = [&](int c){
+        changed[c+1] = (this->*step)(a,c+1,&deltas[c+1]);
+    };
+    if (scorePool != NULL)
+        scorePool->Run(N,body);
+    else
+        for(int c=0; c < N; c++) body(c);
+    bool change = false;
+    for(int d=1; d < N+1; d++){
+        if (!changed[d])
+            continue;
+        if (add)
+            a->Add(d,&deltas[d]);
+        else
+            a->Remove(d,&deltas[d]);
+        change = true;
+    }
+    return change;
+}
+
+unsigned long long Ghin::Fingerprint(NCluster *c){
+    //FNV-1a over the sets, separated by their sizes
+    unsigned long long h = 14695981039346656037ULL;
+    for(int i=0; i < c->GetN(); i++){
+        IOSet *a = c->GetSet(i);
+        h = (h ^ (unsigned long long)a->Size()) * 1099511628211ULL;
+        for(int j=0; j < a->Size(); j++)
+            h = (h ^ a->At(j)) * 1099511628211ULL;
+    }
+    return h;
+}
+
+bool Ghin::MaximizeDomain(ClusterView *a, int domain,bool add ){
+    //the changes are computed against the current set before it is modified in place
+    IOSet *delta = ScratchSet(0);
     if(!add){
        // cout<<"\nRemoving";
-        IOSet *removed = RemoveSet_Reward(a,domain);
-        if( removed != NULL){
-            IOSet *diff = Difference(c,removed);
-            diff->SetId(domain);
-            a->GetSetById(domain)->DeepCopy(diff);
-            delete removed;
-            delete diff;
-            ret = true;
-        }
+        if (!(this->*reward->removeSet)(a,domain,delta))
+            return false;
+        a->Remove(domain,delta);
     }else{
-        IOSet *add = AddSet_Reward(a,domain);
-        //if(add)
-           // cout<<"\n( "<<domain<<") Added "<<add->Size()<<" objects";
-       // else
-        //    cout<<"\nAdded 0 objects";
-        if ( add != NULL){
-            IOSet *unin = Union(c,add);
-            unin->SetId(domain);
-            a->GetSetById(domain)->DeepCopy(unin);
-            delete add;
-            delete unin;
-            ret = true;
-        }
+        if (!(this->*reward->addSet)(a,domain,delta))
+            return false;
+        a->Add(domain,delta);
     }
-    return ret;
+    return true;
 }
 
 
@@ -178,52 +224,186 @@ void Ghin::UpdateTired(NCluster *c){
 
 
 
-IOSet *Ghin::AddSet_Reward(NCluster *a, int domain){
+template<class Reward>
+bool Ghin::AddSet_Reward(ClusterView *a, int domain, IOSet *add){
    // cout<<"\nadd set a: "; a->Output(); cout.flush();
-    IOSet *all = hin->GetLabels(domain);
-    IOSet *test1 = Difference(all,a->GetSetById(domain));
-    delete all;
-    IOSet *add = new IOSet;
-    for(int i=0; i < test1->Size(); i++){
-        if( (*RewardFunc)(a,test1->At(i),domain,w,hin) > 0)
-            add->Add(test1->At(i));
-    }
-    delete test1;
-    if (add->Size() > 0) return add;
-    else{
-        delete add;
-        return NULL;
+    add->Clear();
+    vector<int> &cands = a->GetCandidates(domain);
+    cands.clear();
+    IOSet *in = a->GetSetById(domain);
+    int numObjs = hin->NumObjsInDomain(domain);
+    DealStats &stats = a->GetStats(domain);
+    stats.addCandidates += numObjs - in->Size();
+    const vector<int> *frontier = a->GetFrontier(domain);
+    //an object outside the frontier has no ones in any context, the policy bounds its
+    //reward; only if that bound is at most 0 can such an object never be added
+    bool useFrontier = frontier != NULL && Reward::ZeroOverlapBound(a,domain,w,hin) <= 0;
+    if (useFrontier){
+        cands.assign(frontier->begin(),frontier->end());
+        sort(cands.begin(),cands.end());
+        int k=0, j=0;
+        for(int i=0; i < cands.size(); i++){
+            while (j < in->Size() && in->At(j) < cands[i]) j++;
+            if (j < in->Size() && in->At(j) == cands[i])
+                continue;
+            cands[k++] = cands[i];
+        }
+        cands.resize(k);
+        stats.offFrontier += numObjs - in->Size() - k;
+    }else{
+        //bound the reward of every object from the degrees and set sizes, keep the objects
+        //outside the cluster that may have a positive reward
+        vector<double> &bounds = a->GetBounds(domain);
+        Reward::Bounds(a,domain,w,hin,bounds);
+        int j=0;
+        for(int obj=0; obj < numObjs; obj++){
+            if (j < in->Size() && in->At(j) == obj){
+                j++;
+                continue;
+            }
+            if (bounds[obj] > 0)
+                cands.push_back(obj);
+        }
+        stats.pruned += numObjs - in->Size() - cands.size();
     }
+    if ((long)cands.size()*BULK_RATIO >= numObjs){
+        //most objects survive, scoring the whole domain in one pass is cheaper
+        vector<double> &scores = a->GetScores(domain);
+        Reward::Scores(a,domain,w,hin,scores);
+        for(int i=0; i < cands.size(); i++){
+            if( scores[cands[i]] > 0)
+                add->Add(cands[i]);
+        }
+#ifndef NDEBUG
+        if (useFrontier){
+            //every object off the frontier scores at most 0, see ZeroOverlapBound
+            vector<double> &onFrontier = a->GetBounds(domain);
+            onFrontier.assign(numObjs,0.0);
+            for(int i=0; i < frontier->size(); i++) onFrontier[(*frontier)[i]] = 1.0;
+            for(int obj=0; obj < numObjs; obj++)
+                assert(onFrontier[obj] != 0 || scores[obj] <= 0);
+        }
+#endif
+    }else{
+        ScoreCandidates<Reward>(a,domain,cands,1,add);
+    }
+    return add->Size() > 0;
 }
 
-IOSet *Ghin::RemoveSet_Reward(NCluster *a, int domain){
+template<class Reward>
+bool Ghin::RemoveSet_Reward(ClusterView *a, int domain, IOSet *remove){
    // cout<<"\nremove set a: "; a->Output(); cout.flush();
-    IOSet *remove = new IOSet;
-    for(int i=0; i < a->GetSetById(domain)->Size(); i++){
-        if( (*RewardFunc)(a,a->GetSetById(domain)->At(i),domain,w,hin) < 0)
-            remove->Add(a->GetSetById(domain)->At(i));
-    }
-    if (remove->Size() > 0) return remove;
-    else{
-        delete remove;
-        return NULL;
+    remove->Clear();
+    IOSet *in = a->GetSetById(domain);
+    vector<int> &cands = a->GetCandidates(domain);
+    cands.resize(in->Size());
+    for(int i=0; i < in->Size(); i++) cands[i] = in->At(i);
+    ScoreCandidates<Reward>(a,domain,cands,-1,remove);
+    return remove->Size() > 0;
+}
+
+template<class Reward>
+void Ghin::ScoreCandidates(ClusterView *a, int domain, const vector<int> &cands, int sign, IOSet *out){
+    int n = cands.size();
+    int numChunks = scorePool == NULL ? 1 : min(n/PARALLEL_GRAIN, 4*scorePool->GetNumThreads());
+    if (numChunks < 2){
+        for(int i=0; i < n; i++){
+            if( sign*Reward::Score(a,cands[i],domain,w,hin) > 0)
+                out->Add(cands[i]);
+        }
+        return;
     }
+    //every chunk scores a consecutive run of the candidates into its own buffer
+    Reward::Prepare(a,domain,hin);
+    vector< vector<int> > &buffers = a->GetChunkBuffers(domain,numChunks);
+    scorePool->Run(numChunks,[&](int c){
+        vector<int> &buffer = buffers[c];
+        buffer.clear();
+        int end = (long)n*(c+1)/numChunks;
+        for(int i=(long)n*c/numChunks; i < end; i++){
+            if( sign*Reward::Score(a,cands[i],domain,w,hin) > 0)
+                buffer.push_back(cands[i]);
+        }
+    });
+    //the runs are in order, so concatenating the buffers keeps out sorted
+    for(int c=0; c < numChunks; c++){
+        for(int i=0; i < buffers[c].size(); i++) out->Add(buffers[c][i]);
+    }
+}
 
+template<class Reward>
+double Ghin::TotalReward(NCluster *c){
+    //counted directly: the shared counters belong to the deals, and resetting them for
+    //every stored cluster would cost more than scoring its members
+    ClusterView view(c,hin,csr,NULL);
+    double total = 0;
+    for(int d=1; d <= hin->GetNumNodes(); d++){
+        Reward::Prepare(&view,d,hin);
+        IOSet *in = c->GetSetById(d);
+        for(int i=0; i < in->Size(); i++)
+            total += Reward::Score(&view,in->At(i),d,w,hin);
+    }
+    return total;
+}
+
+const Ghin::RewardEntry Ghin::REWARDS[] = {
+    {SIMPLE_WEIGHTED, "SIMPLE WEIGHTED",
+        &Ghin::AddSet_Reward<SimpleWeightedReward>, &Ghin::RemoveSet_Reward<SimpleWeightedReward>,
+        &Ghin::TotalReward<SimpleWeightedReward>},
+    {EXPECTED_HYPGEO_SAT, "HYPO-GEOMETRIC EXPECTED SATISFACTION",
+        &Ghin::AddSet_Reward<HypGeoReward>, &Ghin::RemoveSet_Reward<HypGeoReward>,
+        &Ghin::TotalReward<HypGeoReward>},
+    {EXPECTED_BETABINOMIAL_SAT, "BETA-BINOMIAL EXPECTED SATISFACTION",
+        &Ghin::AddSet_Reward<BetaBinomialReward>, &Ghin::RemoveSet_Reward<BetaBinomialReward>,
+        &Ghin::TotalReward<BetaBinomialReward>},
+    {-1, NULL, NULL, NULL, NULL}
+};
+
+bool Ghin::SetRewardMode(int mode){
+    for(int i=0; REWARDS[i].mode != -1; i++){
+        if (REWARDS[i].mode == mode){
+            reward = &REWARDS[i];
+            rewardMode = mode;
+            return true;
+        }
+    }
+    return false;
 }
 
 
 
 void  Ghin::GHIN_Alg(){
-    srand ( time(NULL) );
+    if (seed < 0)
+        seed = time(NULL);
+    //the core library may still draw from rand()
+    srand ( seed );
+    if (csr == NULL){
+        //the bit-matrices only serve direct counting
+        int dense = !directMode ? CsrGraph::DENSE_NONE : (denseMode ? CsrGraph::DENSE_ALL : CsrGraph::DENSE_AUTO);
+        csr = new CsrGraph(hin,dense);
+    }
+    if (overlaps == NULL && !directMode)
+        overlaps = new OverlapCounts(hin,csr);
+    if (scorePool == NULL && dealThreads > 1)
+        scorePool = new WorkerPool(dealThreads);
     //1. mark domains (optional)
     //2. Set selection set to everything
     NCluster *selection = MakeInitialSampleSet();
     NCluster *clustered = new NCluster(hin->GetNumNodes());
+    for(int i=0; i < clustered->GetN(); i++) clustered->GetSet(i)->SetId(i+1);
+    SampleFrom(selection);
+    if (numThreads > 1 && pipelineMode){
+        GHIN_Alg_Pipeline(selection,clustered);
+        return;
+    }
+    if (numThreads > 1){
+        GHIN_Alg_Threads(selection,clustered);
+        return;
+    }
     int maxNoSample = hin->GetNumNodes()*2; //stop the algorithm if a random sampling returns NULL this many times in a row
                                             //this typically indicates that the number of remaining objects is too small to
                                             //find randomly connected subspaces...hence terminate the algorithm
     int noSampleCtr=0;
-    for(int i=0; i < clustered->GetN(); i++) clustered->GetSet(i)->SetId(i+1);
     //3. Iteratte until selection is not empty
     while( !SelectEmpty(selection) && totalIters < hin->GetTotalNumObjs()){
          
@@ -231,53 +411,459 @@ void  Ghin::GHIN_Alg(){
        // cout.flush();
         //2. Create initial cluster
         //NCluster *init = SelectInit(strtDomain,selection,clustered);
-        NCluster *init = SelectInit_RandomFreq(selection);
+        Rng sampleRng(seed,2*totalIters+SAMPLE_STREAM);
+        NCluster *init = SelectInit_RandomFreq(selection,&dealPool,sampleRng);
        // cout<<"\ninit: \n"; init->Output();
         if(init != NULL){
             noSampleCtr=0;
-             NCluster *initCopy = new NCluster(*init);
              totalCands++;
-            //3. Attempt to make deal
-            NCluster *result = MakeDeal(init);
+            //3. Attempt to make deal, init is moved into result
+            DealStats stats;
+            Rng dealRng(seed,2*totalIters+DEAL_STREAM);
+            NCluster *result = MakeDeal(init,overlaps,&stats,dealRng);
+            init = NULL;
+            AddStats(stats);
 
-            bool foundCluster=false;
             if (result->GetQuality() == 1 && !CheckRepeat(result)){
-                foundCluster=true;
-                 CONCEPTS.push_back(result);
                  // cout<<"\nafter deal: !\n";
                  // result->Output();
                 if(tiredMode){
                     UpdateTired(result);
                 }
 
-
-                UpdateSampleSet(selection,init,clustered);
+                //4. Update selection
                 UpdateSampleSet(selection,result,clustered);
+                //CONCEPTS takes ownership of result
+                StoreCluster(result);
+            }else{
+                delete result;
             }
-            //4. Update selection
-            delete initCopy;
-            if (!foundCluster) delete result;
-            delete init;
         }else{
             noSampleCtr++;
             if(noSampleCtr > maxNoSample)
                 break;
         }
-        if (dispProgress && (totalIters % 1 == 0)) {
-                 cout<<"\nProgress...";
-                 for(int i=0; i < hin->GetNumNodes(); i++)
-                        cout<<"\n"<<selection->GetSet(i)->Size()<<" of "<<hin->NumObjsInDomain(i+1);
-                 cout<<"\nGot "<<CONCEPTS.size()<<" clusters...\nnum_iters: "<<totalIters;
-
-       }
+        dealPool.Reset();
+        if (dispProgress && (totalIters % 1 == 0))
+            DisplayProgress(selection);
        totalIters++;
     }
 }
 
+//! State shared by the threads of GHIN_Alg_Threads, guarded by lock
+struct Ghin::ThreadRun {
+    mutex lock;
+    //! signalled whenever a seed is drawn, a deal is committed or the run is done
+    condition_variable changed;
+    //! ticket of the next seed drawn, the number of the iteration
+    long nextTicket;
+    //! ticket of the next deal allowed to commit
+    long nextCommit;
+    //! consecutive seeds that could not be sampled
+    int noSampleCtr;
+    //! set once no more seeds are drawn
+    bool done;
+    NCluster *selection;
+    NCluster *clustered;
+};
+
+void Ghin::GHIN_Alg_Threads(NCluster *selection, NCluster *clustered){
+    ThreadRun run;
+    run.nextTicket = 0;
+    run.nextCommit = 0;
+    run.noSampleCtr = 0;
+    run.done = false;
+    run.selection = selection;
+    run.clustered = clustered;
+    vector<thread> workers;
+    vector<OverlapCounts*> counts;
+    for(int i=0; i < numThreads; i++){
+        counts.push_back(DealCounts(i));
+        workers.push_back(thread(&Ghin::DealWorker,this,&run,counts[i]));
+    }
+    for(int i=0; i < numThreads; i++){
+        workers[i].join();
+        if (counts[i] != overlaps)
+            delete counts[i];
+    }
+}
+
+OverlapCounts *Ghin::DealCounts(int i){
+    if (directMode)
+        return NULL;
+    //the calling thread does not deal, its counters serve the first deal thread
+    return i == 0 ? overlaps : new OverlapCounts(hin,csr);
+}
+
+void Ghin::DealWorker(ThreadRun *run, OverlapCounts *counts){
+    int N = hin->GetNumNodes();
+    int maxNoSample = N*2;
+    //every worker has its own counters, pool and statistics
+    DealPool pool;
+    vector<int> seedOverlap(N);
+    //the seed of the current deal, reused so that its block is only grown
+    FlatCluster seedSets;
+    unique_lock<mutex> guard(run->lock);
+    while (!run->done){
+        if (SelectEmpty(run->selection) || totalIters >= hin->GetTotalNumObjs()){
+            run->done = true;
+            run->changed.notify_all();
+            break;
+        }
+        totalIters++;
+        long ticket = run->nextTicket++;
+        Rng sampleRng(seed,2*ticket+SAMPLE_STREAM);
+        NCluster *init = SelectInit_RandomFreq(run->selection,&pool,sampleRng);
+        if (init == NULL){
+            if (++run->noSampleCtr > maxNoSample)
+                run->done = true;
+        }else{
+            run->noSampleCtr = 0;
+            totalCands++;
+        }
+        run->changed.notify_all();
+        NCluster *result = NULL;
+        if (init != NULL){
+            //remember which seed objects are still selectable, the deal is invalid if a
+            //cluster committed in the meantime takes any of them
+            seedSets.Assign(init);
+            for(int i=0; i < N; i++)
+                seedOverlap[i] = seedSets.IntersectCount(i,run->selection->GetSetById(seedSets.GetSetId(i)));
+            guard.unlock();
+            DealStats stats;
+            Rng dealRng(seed,2*ticket+DEAL_STREAM);
+            result = MakeDeal(init,counts,&stats,dealRng);
+            init = NULL;
+            guard.lock();
+            AddStats(stats);
+        }
+
+        //commit in the order the seeds were drawn, and only once the next numThreads-1
+        //seeds are drawn: every worker holds at most one ticket, so the seed of ticket k
+        //is then always drawn after exactly the commits of tickets below k-numThreads+1,
+        //which makes the run independent of the timing of the threads
+        while (run->nextCommit != ticket || (!run->done && run->nextTicket < ticket+numThreads))
+            run->changed.wait(guard);
+        if (result != NULL){
+            bool valid = true;
+            for(int i=0; i < N && valid; i++)
+                valid = seedSets.IntersectCount(i,run->selection->GetSetById(seedSets.GetSetId(i))) == seedOverlap[i];
+            if (!valid){
+                numConflicts++;
+                delete result;
+            }else if (result->GetQuality() == 1 && !CheckRepeat(result)){
+                if(tiredMode)
+                    UpdateTired(result);
+                UpdateSampleSet(run->selection,result,run->clustered);
+                StoreCluster(result);
+            }else{
+                delete result;
+            }
+        }
+        run->nextCommit++;
+        run->changed.notify_all();
+        pool.Reset();
+        if (dispProgress)
+            DisplayProgress(run->selection);
+    }
+    guard.unlock();
+}
+
+//! A seed drawn by the sampler, ticket -1 tells a deal thread to stop
+struct Ghin::SeedItem {
+    long ticket;
+    //! the seed, no sets if the draw failed
+    FlatCluster seed;
+    //! number of objects of every seed set that were selectable when it was drawn
+    vector<int> overlap;
+};
+
+//! A finished deal, ticket -1 tells the collector that a deal thread stopped
+struct Ghin::DealItem {
+    long ticket;
+    //! the deal, no sets if the draw failed
+    FlatCluster result;
+    FlatCluster seed;
+    vector<int> overlap;
+    DealStats stats;
+};
+
+//! State shared by the stages of GHIN_Alg_Pipeline
+struct Ghin::PipelineRun {
+    //! sampler to deal threads
+    BoundedQueue<SeedItem> *seeds;
+    //! deal threads to collector
+    BoundedQueue<DealItem> *results;
+    //! collector to sampler, one entry for every ticket, with no sets if nothing was committed
+    BoundedQueue<FlatCluster> *commits;
+    //! copies of the selection sets and clustered objects owned by the sampler
+    NCluster *selection;
+    NCluster *clustered;
+};
+
+void Ghin::GHIN_Alg_Pipeline(NCluster *selection, NCluster *clustered){
+    int N = hin->GetNumNodes();
+    //no more than lag tickets are ever between their draw and the sampler applying their
+    //commit, so none of the queues can fill up and stall a stage that another one waits on
+    int lag = numThreads+PIPELINE_PREFETCH;
+    PipelineRun run;
+    run.seeds = new BoundedQueue<SeedItem>(lag+numThreads);
+    run.results = new BoundedQueue<DealItem>(lag+numThreads);
+    run.commits = new BoundedQueue<FlatCluster>(lag+1);
+    run.selection = new NCluster(*selection);
+    run.clustered = new NCluster(*clustered);
+    //the sampler draws from its own copy, the commits to selection do not change its tables
+    SampleFrom(run.selection);
+    vector<thread> stages;
+    vector<OverlapCounts*> counts;
+    stages.push_back(thread(&Ghin::PipelineSampler,this,&run));
+    for(int i=0; i < numThreads; i++){
+        counts.push_back(DealCounts(i));
+        stages.push_back(thread(&Ghin::PipelineDealer,this,&run,counts[i]));
+    }
+
+    //collect the deals and commit them in the order the seeds were drawn
+    map<long,DealItem> pending;
+    long next = 0;
+    int stopped = 0;
+    while (stopped < numThreads){
+        DealItem item;
+        run.results->Pop(item);
+        if (item.ticket < 0){
+            stopped++;
+            continue;
+        }
+        pending[item.ticket] = std::move(item);
+        map<long,DealItem>::iterator it;
+        while ((it = pending.find(next)) != pending.end()){
+            DealItem &d = it->second;
+            FlatCluster committed;
+            if (d.seed.GetN() > 0){
+                totalCands++;
+                AddStats(d.stats);
+                //same check as GHIN_Alg_Threads: the seed must not have lost objects to
+                //a cluster committed after it was drawn
+                bool valid = true;
+                for(int i=0; i < N && valid; i++)
+                    valid = d.seed.IntersectCount(i,selection->GetSetById(d.seed.GetSetId(i))) == d.overlap[i];
+                if (!valid){
+                    numConflicts++;
+                }else if (d.result.GetQuality() == 1){
+                    NCluster *result = d.result.ToNCluster();
+                    if (!CheckRepeat(result)){
+                        if(tiredMode)
+                            UpdateTired(result);
+                        UpdateSampleSet(selection,result,clustered);
+                        StoreCluster(result);
+                        committed = std::move(d.result);
+                    }else{
+                        delete result;
+                    }
+                }
+            }
+            run.commits->Push(committed);
+            pending.erase(it);
+            next++;
+            totalIters++;
+            if (dispProgress)
+                DisplayProgress(selection);
+        }
+    }
+    for(int i=0; i < stages.size(); i++)
+        stages[i].join();
+    for(int i=0; i < counts.size(); i++){
+        if (counts[i] != overlaps)
+            delete counts[i];
+    }
+    delete run.selection;
+    delete run.clustered;
+    delete run.seeds;
+    delete run.results;
+    delete run.commits;
+}
+
+void Ghin::PipelineSampler(PipelineRun *run){
+    int N = hin->GetNumNodes();
+    int maxNoSample = N*2;
+    int lag = numThreads+PIPELINE_PREFETCH;
+    DealPool pool;
+    int noSampleCtr = 0;
+    //commits of the tickets below applied are in run->selection
+    long applied = 0;
+    for(long ticket=0; ; ticket++){
+        //seed k is drawn against exactly the commits of the tickets up to k-lag
+        while (applied <= ticket-lag){
+            FlatCluster committed;
+            run->commits->Pop(committed);
+            if (committed.GetN() > 0){
+                NCluster *c = committed.ToNCluster();
+                UpdateSampleSet(run->selection,c,run->clustered);
+                delete c;
+            }
+            applied++;
+        }
+        if (noSampleCtr > maxNoSample || SelectEmpty(run->selection) || ticket >= hin->GetTotalNumObjs())
+            break;
+        Rng sampleRng(seed,2*ticket+SAMPLE_STREAM);
+        NCluster *init = SelectInit_RandomFreq(run->selection,&pool,sampleRng);
+        SeedItem item;
+        item.ticket = ticket;
+        if (init == NULL){
+            noSampleCtr++;
+        }else{
+            noSampleCtr = 0;
+            item.seed.Assign(init);
+            item.overlap.resize(N);
+            for(int i=0; i < N; i++)
+                item.overlap[i] = item.seed.IntersectCount(i,run->selection->GetSetById(item.seed.GetSetId(i)));
+            delete init;
+        }
+        pool.Reset();
+        run->seeds->Push(item);
+    }
+    for(int i=0; i < numThreads; i++){
+        SeedItem stop;
+        stop.ticket = -1;
+        run->seeds->Push(stop);
+    }
+}
+
+void Ghin::PipelineDealer(PipelineRun *run, OverlapCounts *counts){
+    while (true){
+        SeedItem item;
+        run->seeds->Pop(item);
+        DealItem out;
+        out.ticket = item.ticket;
+        if (item.ticket >= 0 && item.seed.GetN() > 0){
+            NCluster *init = item.seed.ToNCluster();
+            Rng dealRng(seed,2*item.ticket+DEAL_STREAM);
+            NCluster *result = MakeDeal(init,counts,&out.stats,dealRng);
+            out.result.Assign(result);
+            delete result;
+            out.seed = std::move(item.seed);
+            out.overlap.swap(item.overlap);
+        }
+        run->results->Push(out);
+        if (item.ticket < 0)
+            break;
+    }
+}
+
+void Ghin::AddStats(const DealStats &stats){
+    avgNashIters += stats.nashIters;
+    numAddCandidates += stats.addCandidates;
+    numPruned += stats.pruned;
+    numOffFrontier += stats.offFrontier;
+    numOscillations += stats.oscillations;
+}
+
+void Ghin::DisplayProgress(NCluster *selection){
+    cout<<"\nProgress...";
+    for(int i=0; i < hin->GetNumNodes(); i++)
+        cout<<"\n"<<selection->GetSet(i)->Size()<<" of "<<hin->NumObjsInDomain(i+1);
+    cout<<"\nGot "<<CONCEPTS.size()<<" clusters...\nnum_iters: "<<totalIters;
+}
+
+void Ghin::RetainDistinct(){
+    //the top K modes retain the distinct clusters while running
+    if (enumerationMode == ENUM_TOPK_MEM || enumerationMode == ENUM_TOPK_FILE)
+        return;
+    for(int i=0; i < CONCEPTS.size(); i++)
+        CONCEPTS[i]->SetQuality(ClusterQuality(CONCEPTS[i]));
+    //position of every cluster in the order found, taken while they all exist
+    unordered_map<NCluster*,int> found;
+    for(int i=0; i < CONCEPTS.size(); i++)
+        found[CONCEPTS[i]] = i;
+    OverlapIndex index(ovlpThresh,seed);
+    QualityHeap heap;
+    vector<NCluster*> kept;
+    for(int i=0; i < CONCEPTS.size(); i++)
+        RetainTopK_OverlapIndexed(kept,CONCEPTS[i],AverageOverlap,index,heap,INT_MAX);
+    vector< pair<int,NCluster*> > order;
+    for(int i=0; i < kept.size(); i++)
+        order.push_back(make_pair(found[kept[i]],kept[i]));
+    sort(order.begin(),order.end());
+    CONCEPTS.clear();
+    repeats.Clear();
+    for(int i=0; i < order.size(); i++){
+        CONCEPTS.push_back(order[i].second);
+        repeats.Add(order[i].second);
+    }
+}
+
+//heap order of the top K clusters, the root is the cluster of lowest quality
+static bool QualityAbove(NCluster *a, NCluster *b){
+    return a->GetQuality() > b->GetQuality();
+}
+
+void Ghin::StoreCluster(NCluster *c){
+    if (enumerationMode != ENUM_TOPK_MEM && enumerationMode != ENUM_TOPK_FILE){
+        CONCEPTS.push_back(c);
+        repeats.Add(c);
+        return;
+    }
+    c->SetQuality(ClusterQuality(c));
+    if (distinctMode){
+        if (distinctIndex == NULL)
+            distinctIndex = new OverlapIndex(ovlpThresh,seed);
+        vector<NCluster*> dropped;
+        bool kept = RetainTopK_OverlapIndexed(CONCEPTS,c,AverageOverlap,*distinctIndex,distinctHeap,topKK,&dropped);
+        for(int i=0; i < dropped.size(); i++){
+            if (dropped[i] != c)
+                repeats.Remove(dropped[i]);
+            delete dropped[i];
+        }
+        if (kept)
+            repeats.Add(c);
+        return;
+    }
+    if (CONCEPTS.size() >= topKK){
+        //full, c has to beat the worst cluster kept
+        if (topKK <= 0 || c->GetQuality() <= CONCEPTS.front()->GetQuality()){
+            delete c;
+            return;
+        }
+        pop_heap(CONCEPTS.begin(),CONCEPTS.end(),QualityAbove);
+        repeats.Remove(CONCEPTS.back());
+        delete CONCEPTS.back();
+        CONCEPTS.pop_back();
+    }
+    CONCEPTS.push_back(c);
+    push_heap(CONCEPTS.begin(),CONCEPTS.end(),QualityAbove);
+    repeats.Add(c);
+}
+
+void Ghin::SortTopK(){
+    if (enumerationMode != ENUM_TOPK_MEM && enumerationMode != ENUM_TOPK_FILE)
+        return;
+    //with distinctMode CONCEPTS is not a heap, see StoreCluster
+    if (distinctMode)
+        stable_sort(CONCEPTS.begin(),CONCEPTS.end(),QualityAbove);
+    else
+        sort_heap(CONCEPTS.begin(),CONCEPTS.end(),QualityAbove);
+}
+
+double Ghin::ClusterQuality(NCluster *c){
+    if (qualityMode == TOTAL_REWARD)
+        return (this->*reward->totalReward)(c);
+    if (params.size() < 1){
+        //the quality functions measure the cluster around its articulation domain
+        IOSet *artDomains = hin->GetArtDomains();
+        params.push_back(artDomains->Size() > 0 ? artDomains->At(0) : 1);
+        delete artDomains;
+    }
+    if (qualityMode == BETA){
+        if (params.size() < 2)
+            params.push_back(beta);
+        return Beta(c,params);
+    }
+    return Area(c,params);
+}
+
 ///////////////////HELPER FUNCTIONS/////////////////////////////////////////////
-int Ghin::SelectRandomDomain(){
+int Ghin::SelectRandomDomain(Rng &rng){
 
-   return (rand() % hin->GetNumNodes())+1;
+   return rng.Below(hin->GetNumNodes())+1;
 }
 
 bool Ghin::SelectEmpty(NCluster* select) {
@@ -292,27 +878,21 @@ bool Ghin::SelectEmpty(NCluster* select) {
     return false;
 
 }
-int Ghin::SelectRandomObjectFromSet(IOSet *a){
+int Ghin::SelectRandomObjectFromSet(IOSet *a, Rng &rng){
      if (a->Size() == 1)
          return a->At(0);
      else if (a->Size() == 0)
          return -1;
-    return a->At(rand() % a->Size());
+    return a->At(rng.Below(a->Size()));
 }
 
 bool Ghin::CheckRepeat(NCluster *a){
     if(CONCEPTS.size() == 0) return false;
-    else{
-        for(int i=0; i < CONCEPTS.size(); i++){
-            for(int j=0; j < hin->GetNumNodes(); j++){
-                if ( a->GetSet(j)->Equal(*CONCEPTS[i]->GetSet(j)) || a->GetSet(j)->Size() < 1)
-                    return true;
-
-            }
-        }
-        return false;
-
+    for(int j=0; j < hin->GetNumNodes(); j++){
+        if (a->GetSet(j)->Size() < 1)
+            return true;
     }
+    return repeats.FindSet(a);
 }
 
 NCluster* Ghin::MakeInitialSampleSet(){
@@ -328,16 +908,17 @@ NCluster* Ghin::MakeInitialSampleSet(){
 
 
 
+void Ghin::SampleFrom(NCluster *selection){
+    sampledSelection = selection;
+    selectionVersion++;
+}
+
 void Ghin::UpdateSampleSet(NCluster *selection, NCluster *currCluster, NCluster *clustered){
     for(int i=0; i < hin->GetNumNodes(); i++){
-        IOSet *n = Difference(selection->GetSetById(i+1),currCluster->GetSetById(i+1));
-        n->SetId(i+1);
-        IOSet *u = Union(currCluster->GetSetById(i+1),clustered->GetSetById(i+1));
-        u->SetId(i+1);
-        clustered->GetSetById(i+1)->DeepCopy(u);
-        selection->GetSetById(i+1)->DeepCopy(n);
-        delete u;
-        delete n;
+        DifferenceInPlace(selection->GetSetById(i+1),currCluster->GetSetById(i+1));
+        UnionInPlace(clustered->GetSetById(i+1),currCluster->GetSetById(i+1));
     }
+    if (selection == sampledSelection)
+        selectionVersion++;
 
 }
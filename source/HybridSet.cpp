@@ -0,0 +1,91 @@
+#include "../headers/HybridSet.h"
+
+static inline int NumWords(int universe){
+    return (universe + 63) / 64;
+}
+
+HybridSet::HybridSet(){
+    type = ARRAY;
+    size = 0;
+    universe = 0;
+}
+
+void HybridSet::Assign(IOSet *a, int universe){
+    this->universe = universe;
+    Build(a->Size() > 0 ? &(*a->GetBegin()) : NULL, a->Size());
+}
+
+int HybridSet::IntersectCount(const unsigned int *bb, int nb){
+    int k=0;
+    if (type == BITMAP){
+        for(int j=0; j < nb; j++){
+            unsigned int x = bb[j];
+            k += x < (unsigned int)universe && ((bits[x >> 6] >> (x & 63)) & 1ULL);
+        }
+    }else if (type == RUN){
+        int r=0;
+        for(int j=0; j < nb && r < runs.size(); j++){
+            unsigned int x = bb[j];
+            while (r < runs.size() && runs[r].second < x) r++;
+            if (r < runs.size() && runs[r].first <= x) k++;
+        }
+    }else if (size > 0 && nb > 0){
+        k = SortedIntersectCount(&arr[0], size, bb, nb);
+    }
+    return k;
+}
+
+void HybridSet::GetBits(vector<unsigned long long> &w, int nwords){
+    w.assign(nwords,0ULL);
+    if (type == BITMAP){
+        copy(bits.begin(), bits.begin() + min((int)bits.size(),nwords), w.begin());
+    }else if (type == RUN){
+        for(int r=0; r < runs.size(); r++){
+            unsigned int s = runs[r].first, e = runs[r].second;
+            unsigned int sw = s >> 6, ew = e >> 6;
+            if (sw == ew){
+                w[sw] |= (~0ULL >> (63 - (e - s))) << (s & 63);
+            }else{
+                w[sw] |= ~0ULL << (s & 63);
+                for(unsigned int k=sw+1; k < ew; k++) w[k] = ~0ULL;
+                w[ew] |= ~0ULL >> (63 - (e & 63));
+            }
+        }
+    }else{
+        for(int i=0; i < size; i++) w[arr[i] >> 6] |= 1ULL << (arr[i] & 63);
+    }
+}
+
+int HybridSet::CountRuns(const unsigned int *v, int n){
+    if (n == 0) return 0;
+    int cnt=1;
+    for(int i=1; i < n; i++)
+        if (v[i] != v[i-1]+1) cnt++;
+    return cnt;
+}
+
+void HybridSet::Build(const unsigned int *v, int n){
+    arr.clear();
+    bits.clear();
+    runs.clear();
+    size = n;
+    long arrayBytes = 4L*size;
+    long bitmapBytes = 8L*NumWords(universe);
+    long runBytes = 8L*CountRuns(v,n);
+    if (runBytes < arrayBytes && runBytes < bitmapBytes){
+        type = RUN;
+        for(int i=0; i < size; i++){
+            if (i == 0 || v[i] != v[i-1]+1)
+                runs.push_back(make_pair(v[i],v[i]));
+            else
+                runs.back().second = v[i];
+        }
+    }else if (bitmapBytes < arrayBytes){
+        type = BITMAP;
+        bits.assign(NumWords(universe),0ULL);
+        for(int i=0; i < size; i++) bits[v[i] >> 6] |= 1ULL << (v[i] & 63);
+    }else{
+        type = ARRAY;
+        arr.assign(v, v+n);
+    }
+}
@@ -0,0 +1,88 @@
+#include "../headers/OverlapCounts.h"
+
+OverlapCounts::OverlapCounts(RelationGraph *hin, CsrGraph *csr){
+    this->csr = csr;
+    int n = hin->GetNumNodes();
+    counts.resize(n+1);
+    total.resize(n+1);
+    frontier.resize(n+1);
+    pos.resize(n+1);
+    members.resize(n+1);
+    memberPos.resize(n+1);
+    for(int d=1; d < n+1; d++){
+        total[d].assign(hin->NumObjsInDomain(d),0);
+        pos[d].assign(hin->NumObjsInDomain(d),-1);
+        memberPos[d].assign(hin->NumObjsInDomain(d),-1);
+        counts[d].assign((long)csr->GetNeighbors(d).size()*hin->NumObjsInDomain(d),0);
+    }
+}
+
+void OverlapCounts::Reset(const vector<IOSet*> &sets){
+    //taking the objects of the previous cluster out again leaves every count, total and
+    //frontier entry they touched at 0, and the others were never touched
+    for(int t=1; t < members.size(); t++){
+        while (!members[t].empty())
+            Leave(t,members[t].back());
+    }
+    for(int t=1; t < sets.size(); t++)
+        Add(t,sets[t]);
+}
+
+void OverlapCounts::Join(int t, unsigned int x){
+    memberPos[t][x] = members[t].size();
+    members[t].push_back(x);
+    Update(t,x,1);
+}
+
+void OverlapCounts::Leave(int t, unsigned int x){
+    unsigned int last = members[t].back();
+    members[t][memberPos[t][x]] = last;
+    memberPos[t][last] = memberPos[t][x];
+    members[t].pop_back();
+    memberPos[t][x] = -1;
+    Update(t,x,-1);
+}
+
+void OverlapCounts::Update(int t, unsigned int x, int delta){
+    //the object-set of x in (t,d) lists exactly the objects of d whose overlap with C_t changes
+    const vector<int> &neighbors = csr->GetNeighbors(t);
+    const vector<CsrContext*> &contexts = csr->GetContexts(t);
+    for(int i=0; i < neighbors.size(); i++){
+        int d = neighbors[i];
+        int *c = counts[d].data() + (long)csr->GetNeighborIndex(d,t)*total[d].size();
+        int *tot = total[d].data();
+        SetSpan row = contexts[i]->GetSet(t,x);
+        for(int j=0; j < row.size; j++){
+            unsigned int o = row.data[j];
+            c[o] += delta;
+            tot[o] += delta;
+            //o enters or leaves the frontier when its total moves between 0 and 1
+            if (delta > 0 && tot[o] == 1){
+                pos[d][o] = frontier[d].size();
+                frontier[d].push_back(o);
+            }else if (delta < 0 && tot[o] == 0){
+                int last = frontier[d].back();
+                frontier[d][pos[d][o]] = last;
+                pos[d][last] = pos[d][o];
+                frontier[d].pop_back();
+                pos[d][o] = -1;
+            }
+        }
+    }
+}
+
+void OverlapCounts::Add(int t, unsigned int x){
+    Join(t,x);
+}
+
+void OverlapCounts::Remove(int t, unsigned int x){
+    Leave(t,x);
+}
+
+void OverlapCounts::Add(int t, IOSet *xs){
+    for(int i=0; i < xs->Size(); i++) Join(t,xs->At(i));
+}
+
+void OverlapCounts::Remove(int t, IOSet *xs){
+    for(int i=0; i < xs->Size(); i++) Leave(t,xs->At(i));
+}
@@ -0,0 +1,119 @@
+#include "../headers/OverlapIndex.h"
+
+const double OverlapIndex::MIN_RECALL = 0.98;
+
+OverlapIndex::OverlapIndex(double thresh, unsigned long long seed){
+    this->thresh = thresh;
+    //the most rows per band that still finds a pair at the threshold with MIN_RECALL
+    rows = 0;
+    bands = 0;
+    for(int r=NUM_HASHES; r >= 1 && thresh > 0; r--){
+        int b = NUM_HASHES/r;
+        double miss = pow(1.0-pow(min(thresh,1.0),r),b);
+        if (1.0-miss >= MIN_RECALL){
+            rows = r;
+            bands = b;
+            break;
+        }
+    }
+    hashSeeds.resize(NUM_HASHES);
+    unsigned long long s = seed;
+    for(int i=0; i < NUM_HASHES; i++){
+        s += 0x9E3779B97F4A7C15ULL;
+        hashSeeds[i] = Mix64(s);
+    }
+    minima.resize(NUM_HASHES);
+}
+
+void OverlapIndex::BandKeys(NCluster *c, vector<unsigned long long> &out){
+    out.clear();
+    for(int d=0; d < c->GetN(); d++){
+        IOSet *a = c->GetSet(d);
+        fill(minima.begin(),minima.end(),~0ULL);
+        for(int j=0; j < a->Size(); j++){
+            unsigned long long x = (unsigned int)a->At(j);
+            for(int h=0; h < NUM_HASHES; h++)
+                minima[h] = min(minima[h],Mix64(x ^ hashSeeds[h]));
+        }
+        for(int b=0; b < bands; b++){
+            unsigned long long key = (unsigned long long)b;
+            for(int r=0; r < rows; r++)
+                key = Mix64(key ^ minima[b*rows+r]);
+            out.push_back(key);
+        }
+    }
+}
+
+void OverlapIndex::Insert(int id, NCluster *c){
+    vector<unsigned long long> &k = keys[id];
+    if (rows == 0)
+        return;
+    BandKeys(c,k);
+    if (tables.size() < k.size())
+        tables.resize(k.size());
+    for(int t=0; t < k.size(); t++)
+        tables[t][k[t]].push_back(id);
+}
+
+void OverlapIndex::Remove(int id){
+    unordered_map<int, vector<unsigned long long> >::iterator it = keys.find(id);
+    if (it == keys.end())
+        return;
+    vector<unsigned long long> &k = it->second;
+    for(int t=0; t < k.size(); t++){
+        Buckets::iterator b = tables[t].find(k[t]);
+        vector<int> &ids = b->second;
+        ids.erase(find(ids.begin(),ids.end(),id));
+        if (ids.empty())
+            tables[t].erase(b);
+    }
+    keys.erase(it);
+}
+
+void OverlapIndex::Move(int id, int to){
+    unordered_map<int, vector<unsigned long long> >::iterator it = keys.find(id);
+    if (it == keys.end())
+        return;
+    vector<unsigned long long> &k = it->second;
+    for(int t=0; t < k.size(); t++){
+        vector<int> &ids = tables[t][k[t]];
+        *find(ids.begin(),ids.end(),id) = to;
+    }
+    keys[to].swap(k);
+    keys.erase(id);
+}
+
+void OverlapIndex::Candidates(NCluster *c, vector<int> &out){
+    out.clear();
+    if (rows == 0){
+        //the threshold is too low to band, every cluster is a candidate
+        for(unordered_map<int, vector<unsigned long long> >::iterator it = keys.begin(); it != keys.end(); it++)
+            out.push_back(it->first);
+        sort(out.begin(),out.end());
+        return;
+    }
+    vector<unsigned long long> k;
+    BandKeys(c,k);
+    for(int t=0; t < k.size() && t < tables.size(); t++){
+        Buckets::iterator b = tables[t].find(k[t]);
+        if (b == tables[t].end())
+            continue;
+        for(int i=0; i < b->second.size(); i++){
+            int id = b->second[i];
+            if (id >= seen.size())
+                seen.resize(id+1,0);
+            if (!seen[id]){
+                seen[id] = 1;
+                out.push_back(id);
+            }
+        }
+    }
+    for(int i=0; i < out.size(); i++)
+        seen[out[i]] = 0;
+    sort(out.begin(),out.end());
+}
+
+void OverlapIndex::Clear(){
+    tables.clear();
+    keys.clear();
+}
@@ -0,0 +1,59 @@
+#include "../headers/RepeatIndex.h"
+
+SetFingerprint FingerprintSet(IOSet *a){
+    //two independent 64 bit hashes of the size and the sorted elements: FNV-1a and a
+    //multiply-mix chain
+    SetFingerprint f;
+    unsigned long long n = (unsigned long long)a->Size();
+    f.lo = (14695981039346656037ULL ^ n) * 1099511628211ULL;
+    f.hi = Mix64(n + 0x9E3779B97F4A7C15ULL);
+    for(int i=0; i < a->Size(); i++){
+        unsigned long long x = (unsigned int)a->At(i);
+        f.lo = (f.lo ^ x) * 1099511628211ULL;
+        f.hi = Mix64(f.hi ^ (x + 0x9E3779B97F4A7C15ULL));
+    }
+    f.lo = Mix64(f.lo);
+    return f;
+}
+
+RepeatIndex::RepeatIndex(){
+    indexed=0;
+}
+
+void RepeatIndex::Add(NCluster *c){
+    if (byPosition.size() < c->GetN())
+        byPosition.resize(c->GetN());
+    for(int j=0; j < c->GetN(); j++)
+        byPosition[j][FingerprintSet(c->GetSet(j))].push_back(c);
+    indexed++;
+}
+
+void RepeatIndex::Remove(NCluster *c){
+    for(int j=0; j < c->GetN(); j++){
+        SetMap::iterator it = byPosition[j].find(FingerprintSet(c->GetSet(j)));
+        vector<NCluster*> &found = it->second;
+        found.erase(find(found.begin(),found.end(),c));
+        if (found.empty())
+            byPosition[j].erase(it);
+    }
+    indexed--;
+}
+
+bool RepeatIndex::FindSet(NCluster *a){
+    for(int j=0; j < a->GetN() && j < byPosition.size(); j++){
+        SetMap::const_iterator it = byPosition[j].find(FingerprintSet(a->GetSet(j)));
+        if (it == byPosition[j].end())
+            continue;
+        //a fingerprint match is confirmed element by element
+        for(int k=0; k < it->second.size(); k++){
+            if (a->GetSet(j)->Equal(*it->second[k]->GetSet(j)))
+                return true;
+        }
+    }
+    return false;
+}
+
+void RepeatIndex::Clear(){
+    byPosition.clear();
+    indexed=0;
+}
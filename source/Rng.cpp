@@ -0,0 +1,104 @@
+#include "../headers/Rng.h"
+
+//multipliers and key increments of Philox4x32
+static const unsigned int PHILOX_M0 = 0xD2511F53;
+static const unsigned int PHILOX_M1 = 0xCD9E8D57;
+static const unsigned int PHILOX_W0 = 0x9E3779B9;
+static const unsigned int PHILOX_W1 = 0xBB67AE85;
+static const int PHILOX_ROUNDS = 10;
+
+Rng::Rng(unsigned long long seed, unsigned long long stream){
+    Seed(seed,stream);
+}
+
+void Rng::Seed(unsigned long long seed, unsigned long long stream){
+    key[0] = (unsigned int)seed;
+    key[1] = (unsigned int)(seed >> 32);
+    ctr[0] = 0;
+    ctr[1] = 0;
+    ctr[2] = (unsigned int)stream;
+    ctr[3] = (unsigned int)(stream >> 32);
+    pos = 4;
+}
+
+void Rng::Refill(){
+    unsigned int x0 = ctr[0], x1 = ctr[1], x2 = ctr[2], x3 = ctr[3];
+    unsigned int k0 = key[0], k1 = key[1];
+    for(int r=0; r < PHILOX_ROUNDS; r++){
+        unsigned long long p0 = (unsigned long long)PHILOX_M0 * x0;
+        unsigned long long p1 = (unsigned long long)PHILOX_M1 * x2;
+        unsigned int y0 = (unsigned int)(p1 >> 32) ^ x1 ^ k0;
+        unsigned int y1 = (unsigned int)p1;
+        unsigned int y2 = (unsigned int)(p0 >> 32) ^ x3 ^ k1;
+        unsigned int y3 = (unsigned int)p0;
+        x0 = y0; x1 = y1; x2 = y2; x3 = y3;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = x0; out[1] = x1; out[2] = x2; out[3] = x3;
+    pos = 0;
+    //the block number is 64 bits, the stream half of the counter is never touched
+    if (++ctr[0] == 0)
+        ctr[1]++;
+}
+
+int Rng::Below(int n){
+    //Lemire's multiply and reject
+    unsigned long long m = (unsigned long long)Next32() * (unsigned int)n;
+    unsigned int low = (unsigned int)m;
+    if (low < (unsigned int)n){
+        unsigned int threshold = (0u - (unsigned int)n) % (unsigned int)n;
+        while (low < threshold){
+            m = (unsigned long long)Next32() * (unsigned int)n;
+            low = (unsigned int)m;
+        }
+    }
+    return (int)(m >> 32);
+}
+
+int WeightedUniformDraw(Rng &rng, vector<long double> &weights){
+    long double r = rng.Uniform();
+    long double c = 0;
+    for(int i=0; i < weights.size(); i++){
+        c += weights[i];
+        if (r < c)
+            return i;
+    }
+    //rounding left the sum of the weights just below r, take the last non-zero weight
+    for(int i=weights.size()-1; i > 0; i--){
+        if (weights[i] > 0)
+            return i;
+    }
+    return 0;
+}
+
+IOSet *UniformSubsetDraw(Rng &rng, IOSet *t){
+    IOSet *ret = new IOSet;
+    unsigned int bits = 0;
+    for(int i=0; i < t->Size(); i++){
+        if (i % 32 == 0)
+            bits = rng.Next32();
+        if (bits & 1)
+            ret->Add(t->At(i));
+        bits >>= 1;
+    }
+    return ret;
+}
+
+IOSet *BinomialSubsetDraw(Rng &rng, IOSet *t){
+    //marking one element uniformly and taking every other one with probability 1/2
+    //draws S with probability |S|/(n 2^(n-1))
+    if (t->Size() == 0)
+        return new IOSet;
+    int marked = rng.Below(t->Size());
+    IOSet *ret = new IOSet;
+    unsigned int bits = 0;
+    for(int i=0; i < t->Size(); i++){
+        if (i % 32 == 0)
+            bits = rng.Next32();
+        if (i == marked || (bits & 1))
+            ret->Add(t->At(i));
+        bits >>= 1;
+    }
+    return ret;
+}
@@ -0,0 +1,560 @@
+#include "../headers/SetKernels.h"
+#include <immintrin.h>
+
+//! when one input is this many times larger than the other, gallop over the larger input instead of merging
+static const int GALLOP_RATIO=32;
+
+typedef int (*SetKernel)(const unsigned int *, int, const unsigned int *, int, unsigned int *);
+typedef int (*CountKernel)(const unsigned int *, int, const unsigned int *, int);
+typedef int (*BitCountKernel)(const unsigned long long *, const unsigned long long *, int);
+
+//! pshufb masks that move the 32 bit lanes selected by a 4 bit mask to the front
+static unsigned char shuffle4[16][16];
+//! vpermd indices that move the 32 bit lanes selected by an 8 bit mask to the front
+static int permute8[256][8];
+
+static bool BuildCompactionTables(){
+    for(int m=0; m < 16; m++){
+        int k=0;
+        fill(shuffle4[m], shuffle4[m]+16, 0x80);
+        for(int lane=0; lane < 4; lane++){
+            if (m & (1 << lane)){
+                for(int byte=0; byte < 4; byte++) shuffle4[m][4*k+byte] = 4*lane+byte;
+                k++;
+            }
+        }
+    }
+    for(int m=0; m < 256; m++){
+        int k=0;
+        fill(permute8[m], permute8[m]+8, 0);
+        for(int lane=0; lane < 8; lane++)
+            if (m & (1 << lane)) permute8[m][k++] = lane;
+    }
+    return true;
+}
+static bool tablesBuilt = BuildCompactionTables();
+
+///////////////////////////////scalar kernels//////////////////////////////////
+
+//! returns the first index k >= lo with b[k] >= x, or nb if there is none
+static inline int Gallop(const unsigned int *b, int lo, int nb, unsigned int x){
+    if (lo >= nb || b[lo] >= x) return lo;
+    int step=1;
+    int hi=lo+1;
+    while (hi < nb && b[hi] < x){
+        lo = hi;
+        step <<= 1;
+        hi = lo + step;
+    }
+    if (hi > nb) hi = nb;
+    return lower_bound(b+lo+1, b+hi, x) - b;
+}
+
+//! intersection where a is much smaller than b
+static int GallopIntersect(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out){
+    int k=0, j=0;
+    for(int i=0; i < na; i++){
+        j = Gallop(b,j,nb,a[i]);
+        if (j == nb) break;
+        if (b[j] == a[i]){
+            out[k++] = a[i];
+            j++;
+        }
+    }
+    return k;
+}
+
+//! difference a-b where a is much smaller than b
+static int GallopDifferenceSmallA(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out){
+    int k=0, j=0;
+    for(int i=0; i < na; i++){
+        j = Gallop(b,j,nb,a[i]);
+        if (j == nb || b[j] != a[i]) out[k++] = a[i];
+    }
+    return k;
+}
+
+//! difference a-b where b is much smaller than a, copies the ranges of a between elements of b
+static int GallopDifferenceSmallB(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out){
+    int k=0, pos=0;
+    for(int t=0; t < nb && pos < na; t++){
+        int p = Gallop(a,pos,na,b[t]);
+        copy(a+pos, a+p, out+k);
+        k += p-pos;
+        pos = (p < na && a[p] == b[t]) ? p+1 : p;
+    }
+    copy(a+pos, a+na, out+k);
+    return k + na-pos;
+}
+
+static int ScalarIntersect(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out){
+    int i=0, j=0, k=0;
+    while (i < na && j < nb){
+        if (a[i] < b[j]) i++;
+        else if (b[j] < a[i]) j++;
+        else{
+            out[k++] = a[i];
+            i++; j++;
+        }
+    }
+    return k;
+}
+
+static int GallopIntersectCount(const unsigned int *a, int na, const unsigned int *b, int nb){
+    int k=0, j=0;
+    for(int i=0; i < na; i++){
+        j = Gallop(b,j,nb,a[i]);
+        if (j == nb) break;
+        if (b[j] == a[i]){
+            k++;
+            j++;
+        }
+    }
+    return k;
+}
+
+static int ScalarIntersectCount(const unsigned int *a, int na, const unsigned int *b, int nb){
+    int i=0, j=0, k=0;
+    while (i < na && j < nb){
+        //branch free advance, both pointers move on a match
+        unsigned int x = a[i], y = b[j];
+        k += x == y;
+        i += x <= y;
+        j += y <= x;
+    }
+    return k;
+}
+
+static int ScalarUnion(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out){
+    int i=0, j=0, k=0;
+    while (i < na && j < nb){
+        if (a[i] < b[j]) out[k++] = a[i++];
+        else if (b[j] < a[i]) out[k++] = b[j++];
+        else{
+            out[k++] = a[i];
+            i++; j++;
+        }
+    }
+    while (i < na) out[k++] = a[i++];
+    while (j < nb) out[k++] = b[j++];
+    return k;
+}
+
+static int ScalarDifference(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out){
+    int i=0, j=0, k=0;
+    while (i < na && j < nb){
+        if (a[i] < b[j]) out[k++] = a[i++];
+        else if (b[j] < a[i]) j++;
+        else{
+            i++; j++;
+        }
+    }
+    while (i < na) out[k++] = a[i++];
+    return k;
+}
+
+//! finishes a difference after a block kernel stopped at a[i..i+w) with matches mask against b[0..j)
+static int FinishDifference(const unsigned int *a, int na, const unsigned int *b, int nb,
+                            int i, int j, int w, unsigned int mask, unsigned int *out){
+    int k=0;
+    if (i+w <= na){
+        for(int t=0; t < w; t++){
+            unsigned int x = a[i+t];
+            if ((mask >> t) & 1) continue;
+            while (j < nb && b[j] < x) j++;
+            if (j < nb && b[j] == x) continue;
+            out[k++] = x;
+        }
+        i += w;
+    }
+    return k + ScalarDifference(a+i, na-i, b+j, nb-j, out+k);
+}
+
+///////////////////////////////SSE4.2 kernels//////////////////////////////////
+//!bit t of the result is set if lane t of va equals any lane of vb
+__attribute__((target("sse4.2,popcnt")))
+static inline int Match4(__m128i va, __m128i vb){
+    __m128i m0 = _mm_cmpeq_epi32(va, vb);
+    __m128i m1 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0,3,2,1)));
+    __m128i m2 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1,0,3,2)));
+    __m128i m3 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2,1,0,3)));
+    return _mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(_mm_or_si128(m0,m1),_mm_or_si128(m2,m3))));
+}
+
+__attribute__((target("sse4.2,popcnt")))
+static int IntersectSSE42(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out){
+    int i=0, j=0, k=0;
+    if (na >= 4 && nb >= 4){
+        __m128i va = _mm_loadu_si128((const __m128i*)a);
+        __m128i vb = _mm_loadu_si128((const __m128i*)b);
+        while (true){
+            int mask = Match4(va,vb);
+            _mm_storeu_si128((__m128i*)(out+k), _mm_shuffle_epi8(va, _mm_loadu_si128((const __m128i*)shuffle4[mask])));
+            k += __builtin_popcount(mask);
+            unsigned int amax = a[i+3], bmax = b[j+3];
+            if (amax <= bmax){
+                i += 4;
+                if (i+4 > na) break;
+                va = _mm_loadu_si128((const __m128i*)(a+i));
+            }
+            if (bmax <= amax){
+                j += 4;
+                if (j+4 > nb) break;
+                vb = _mm_loadu_si128((const __m128i*)(b+j));
+            }
+        }
+    }
+    return k + ScalarIntersect(a+i, na-i, b+j, nb-j, out+k);
+}
+
+__attribute__((target("sse4.2,popcnt")))
+static int IntersectCountSSE42(const unsigned int *a, int na, const unsigned int *b, int nb){
+    int i=0, j=0, k=0;
+    if (na >= 4 && nb >= 4){
+        __m128i va = _mm_loadu_si128((const __m128i*)a);
+        __m128i vb = _mm_loadu_si128((const __m128i*)b);
+        while (true){
+            k += __builtin_popcount(Match4(va,vb));
+            unsigned int amax = a[i+3], bmax = b[j+3];
+            if (amax <= bmax){
+                i += 4;
+                if (i+4 > na) break;
+                va = _mm_loadu_si128((const __m128i*)(a+i));
+            }
+            if (bmax <= amax){
+                j += 4;
+                if (j+4 > nb) break;
+                vb = _mm_loadu_si128((const __m128i*)(b+j));
+            }
+        }
+    }
+    return k + ScalarIntersectCount(a+i, na-i, b+j, nb-j);
+}
+
+__attribute__((target("sse4.2,popcnt")))
+static int DifferenceSSE42(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out){
+    int i=0, j=0, k=0;
+    unsigned int mask=0;
+    if (na >= 4 && nb >= 4){
+        __m128i va = _mm_loadu_si128((const __m128i*)a);
+        __m128i vb = _mm_loadu_si128((const __m128i*)b);
+        while (true){
+            mask |= Match4(va,vb);
+            unsigned int amax = a[i+3], bmax = b[j+3];
+            if (amax <= bmax){
+                int keep = ~mask & 15;
+                _mm_storeu_si128((__m128i*)(out+k), _mm_shuffle_epi8(va, _mm_loadu_si128((const __m128i*)shuffle4[keep])));
+                k += __builtin_popcount(keep);
+                mask = 0;
+                i += 4;
+                if (i+4 > na) break;
+                va = _mm_loadu_si128((const __m128i*)(a+i));
+            }
+            if (bmax <= amax){
+                j += 4;
+                if (j+4 > nb) break;
+                vb = _mm_loadu_si128((const __m128i*)(b+j));
+            }
+        }
+    }
+    return k + FinishDifference(a,na,b,nb,i,j,4,mask,out+k);
+}
+
+///////////////////////////////AVX2 kernels////////////////////////////////////
+__attribute__((target("avx2,popcnt")))
+static inline int Match8(__m256i va, __m256i vb){
+    //compare within 128 bit lanes, then again with the lanes of vb swapped
+    __m256i vs = _mm256_permute2x128_si256(vb, vb, 1);
+    __m256i m0 = _mm256_or_si256(_mm256_cmpeq_epi32(va, vb), _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, _MM_SHUFFLE(0,3,2,1))));
+    __m256i m1 = _mm256_or_si256(_mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, _MM_SHUFFLE(1,0,3,2))), _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vb, _MM_SHUFFLE(2,1,0,3))));
+    __m256i m2 = _mm256_or_si256(_mm256_cmpeq_epi32(va, vs), _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vs, _MM_SHUFFLE(0,3,2,1))));
+    __m256i m3 = _mm256_or_si256(_mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vs, _MM_SHUFFLE(1,0,3,2))), _mm256_cmpeq_epi32(va, _mm256_shuffle_epi32(vs, _MM_SHUFFLE(2,1,0,3))));
+    __m256i m = _mm256_or_si256(_mm256_or_si256(m0,m1), _mm256_or_si256(m2,m3));
+    return _mm256_movemask_ps(_mm256_castsi256_ps(m));
+}
+
+__attribute__((target("avx2,popcnt")))
+static inline void Compact8(__m256i va, int mask, unsigned int *out){
+    __m256i idx = _mm256_loadu_si256((const __m256i*)permute8[mask]);
+    _mm256_storeu_si256((__m256i*)out, _mm256_permutevar8x32_epi32(va, idx));
+}
+
+__attribute__((target("avx2,popcnt")))
+static int IntersectAVX2(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out){
+    int i=0, j=0, k=0;
+    if (na >= 8 && nb >= 8){
+        __m256i va = _mm256_loadu_si256((const __m256i*)a);
+        __m256i vb = _mm256_loadu_si256((const __m256i*)b);
+        while (true){
+            int mask = Match8(va,vb);
+            Compact8(va,mask,out+k);
+            k += __builtin_popcount(mask);
+            unsigned int amax = a[i+7], bmax = b[j+7];
+            if (amax <= bmax){
+                i += 8;
+                if (i+8 > na) break;
+                va = _mm256_loadu_si256((const __m256i*)(a+i));
+            }
+            if (bmax <= amax){
+                j += 8;
+                if (j+8 > nb) break;
+                vb = _mm256_loadu_si256((const __m256i*)(b+j));
+            }
+        }
+    }
+    return k + IntersectSSE42(a+i, na-i, b+j, nb-j, out+k);
+}
+
+__attribute__((target("avx2,popcnt")))
+static int IntersectCountAVX2(const unsigned int *a, int na, const unsigned int *b, int nb){
+    int i=0, j=0, k=0;
+    if (na >= 8 && nb >= 8){
+        __m256i va = _mm256_loadu_si256((const __m256i*)a);
+        __m256i vb = _mm256_loadu_si256((const __m256i*)b);
+        while (true){
+            k += __builtin_popcount(Match8(va,vb));
+            unsigned int amax = a[i+7], bmax = b[j+7];
+            if (amax <= bmax){
+                i += 8;
+                if (i+8 > na) break;
+                va = _mm256_loadu_si256((const __m256i*)(a+i));
+            }
+            if (bmax <= amax){
+                j += 8;
+                if (j+8 > nb) break;
+                vb = _mm256_loadu_si256((const __m256i*)(b+j));
+            }
+        }
+    }
+    return k + IntersectCountSSE42(a+i, na-i, b+j, nb-j);
+}
+
+__attribute__((target("avx2,popcnt")))
+static int DifferenceAVX2(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out){
+    int i=0, j=0, k=0;
+    unsigned int mask=0;
+    if (na >= 8 && nb >= 8){
+        __m256i va = _mm256_loadu_si256((const __m256i*)a);
+        __m256i vb = _mm256_loadu_si256((const __m256i*)b);
+        while (true){
+            mask |= Match8(va,vb);
+            unsigned int amax = a[i+7], bmax = b[j+7];
+            if (amax <= bmax){
+                int keep = ~mask & 255;
+                Compact8(va,keep,out+k);
+                k += __builtin_popcount(keep);
+                mask = 0;
+                i += 8;
+                if (i+8 > na) break;
+                va = _mm256_loadu_si256((const __m256i*)(a+i));
+            }
+            if (bmax <= amax){
+                j += 8;
+                if (j+8 > nb) break;
+                vb = _mm256_loadu_si256((const __m256i*)(b+j));
+            }
+        }
+    }
+    return k + FinishDifference(a,na,b,nb,i,j,8,mask,out+k);
+}
+
+///////////////////////////////AVX-512 kernels/////////////////////////////////
+__attribute__((target("avx512f,popcnt")))
+static inline __mmask16 Match16(__m512i va, __m512i vb){
+    //rotations are taken from vb directly so that the comparisons are independent. The
+    //masked form with every lane selected gives the same rotation, but its pass-through
+    //operand is vb instead of an undefined vector, which -Wall reports as uninitialized
+#define ROT_CMP(r) _mm512_cmpeq_epi32_mask(va, _mm512_mask_alignr_epi32(vb, (__mmask16)0xFFFF, vb, vb, r))
+    __mmask16 m0 = _mm512_cmpeq_epi32_mask(va, vb) | ROT_CMP(1) | ROT_CMP(2) | ROT_CMP(3);
+    __mmask16 m1 = ROT_CMP(4) | ROT_CMP(5) | ROT_CMP(6) | ROT_CMP(7);
+    __mmask16 m2 = ROT_CMP(8) | ROT_CMP(9) | ROT_CMP(10) | ROT_CMP(11);
+    __mmask16 m3 = ROT_CMP(12) | ROT_CMP(13) | ROT_CMP(14) | ROT_CMP(15);
+#undef ROT_CMP
+    return m0 | m1 | m2 | m3;
+}
+
+__attribute__((target("avx512f,popcnt")))
+static int IntersectAVX512(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out){
+    int i=0, j=0, k=0;
+    if (na >= 16 && nb >= 16){
+        __m512i va = _mm512_loadu_si512((const void*)a);
+        __m512i vb = _mm512_loadu_si512((const void*)b);
+        while (true){
+            __mmask16 mask = Match16(va,vb);
+            _mm512_mask_compressstoreu_epi32((void*)(out+k), mask, va);
+            k += __builtin_popcount(mask);
+            unsigned int amax = a[i+15], bmax = b[j+15];
+            if (amax <= bmax){
+                i += 16;
+                if (i+16 > na) break;
+                va = _mm512_loadu_si512((const void*)(a+i));
+            }
+            if (bmax <= amax){
+                j += 16;
+                if (j+16 > nb) break;
+                vb = _mm512_loadu_si512((const void*)(b+j));
+            }
+        }
+    }
+    return k + IntersectAVX2(a+i, na-i, b+j, nb-j, out+k);
+}
+
+__attribute__((target("avx512f,popcnt")))
+static int IntersectCountAVX512(const unsigned int *a, int na, const unsigned int *b, int nb){
+    int i=0, j=0, k=0;
+    if (na >= 16 && nb >= 16){
+        __m512i va = _mm512_loadu_si512((const void*)a);
+        __m512i vb = _mm512_loadu_si512((const void*)b);
+        while (true){
+            k += __builtin_popcount(Match16(va,vb));
+            unsigned int amax = a[i+15], bmax = b[j+15];
+            if (amax <= bmax){
+                i += 16;
+                if (i+16 > na) break;
+                va = _mm512_loadu_si512((const void*)(a+i));
+            }
+            if (bmax <= amax){
+                j += 16;
+                if (j+16 > nb) break;
+                vb = _mm512_loadu_si512((const void*)(b+j));
+            }
+        }
+    }
+    return k + IntersectCountAVX2(a+i, na-i, b+j, nb-j);
+}
+
+__attribute__((target("avx512f,popcnt")))
+static int DifferenceAVX512(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out){
+    int i=0, j=0, k=0;
+    unsigned int mask=0;
+    if (na >= 16 && nb >= 16){
+        __m512i va = _mm512_loadu_si512((const void*)a);
+        __m512i vb = _mm512_loadu_si512((const void*)b);
+        while (true){
+            mask |= Match16(va,vb);
+            unsigned int amax = a[i+15], bmax = b[j+15];
+            if (amax <= bmax){
+                __mmask16 keep = ~mask & 0xFFFF;
+                _mm512_mask_compressstoreu_epi32((void*)(out+k), keep, va);
+                k += __builtin_popcount(keep);
+                mask = 0;
+                i += 16;
+                if (i+16 > na) break;
+                va = _mm512_loadu_si512((const void*)(a+i));
+            }
+            if (bmax <= amax){
+                j += 16;
+                if (j+16 > nb) break;
+                vb = _mm512_loadu_si512((const void*)(b+j));
+            }
+        }
+    }
+    return k + FinishDifference(a,na,b,nb,i,j,16,mask,out+k);
+}
+
+///////////////////////////////bitmap kernels//////////////////////////////////
+static int ScalarBitAndCount(const unsigned long long *a, const unsigned long long *b, int nwords){
+    int k=0;
+    for(int i=0; i < nwords; i++) k += __builtin_popcountll(a[i] & b[i]);
+    return k;
+}
+
+__attribute__((target("sse4.2,popcnt")))
+static int PopcntBitAndCount(const unsigned long long *a, const unsigned long long *b, int nwords){
+    //four accumulators so the popcnt instructions do not wait on each other
+    long long k0=0, k1=0, k2=0, k3=0;
+    int i=0;
+    for(; i+4 <= nwords; i+=4){
+        k0 += _mm_popcnt_u64(a[i] & b[i]);
+        k1 += _mm_popcnt_u64(a[i+1] & b[i+1]);
+        k2 += _mm_popcnt_u64(a[i+2] & b[i+2]);
+        k3 += _mm_popcnt_u64(a[i+3] & b[i+3]);
+    }
+    for(; i < nwords; i++) k0 += _mm_popcnt_u64(a[i] & b[i]);
+    return k0+k1+k2+k3;
+}
+
+__attribute__((target("avx2,popcnt")))
+static int AVX2BitAndCount(const unsigned long long *a, const unsigned long long *b, int nwords){
+    //nibble lookup popcount, byte counts are summed into 64 bit lanes with sad
+    const __m256i lookup = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4,
+                                            0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+    int i=0;
+    for(; i+4 <= nwords; i+=4){
+        __m256i v = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(a+i)),
+                                     _mm256_loadu_si256((const __m256i*)(b+i)));
+        __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, _mm256_and_si256(v,low)),
+                                      _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v,4),low)));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, _mm256_setzero_si256()));
+    }
+    long long k = _mm256_extract_epi64(acc,0) + _mm256_extract_epi64(acc,1)
+                + _mm256_extract_epi64(acc,2) + _mm256_extract_epi64(acc,3);
+    for(; i < nwords; i++) k += _mm_popcnt_u64(a[i] & b[i]);
+    return k;
+}
+
+///////////////////////////////dispatch////////////////////////////////////////
+
+static SetKernel intersectKernels[4] = {ScalarIntersect, IntersectSSE42, IntersectAVX2, IntersectAVX512};
+static SetKernel differenceKernels[4] = {ScalarDifference, DifferenceSSE42, DifferenceAVX2, DifferenceAVX512};
+static CountKernel intersectCountKernels[4] = {ScalarIntersectCount, IntersectCountSSE42, IntersectCountAVX2, IntersectCountAVX512};
+static BitCountKernel bitAndCountKernels[4] = {ScalarBitAndCount, PopcntBitAndCount, AVX2BitAndCount, AVX2BitAndCount};
+static int kernelLevel = DetectKernelLevel();
+
+int DetectKernelLevel(){
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return KERNEL_AVX512;
+    if (__builtin_cpu_supports("avx2")) return KERNEL_AVX2;
+    if (__builtin_cpu_supports("sse4.2")) return KERNEL_SSE42;
+    return KERNEL_SCALAR;
+}
+
+int GetKernelLevel(){ return kernelLevel; }
+
+void SetKernelLevel(int level){
+    kernelLevel = min(max(level,KERNEL_SCALAR), DetectKernelLevel());
+}
+
+const char *KernelLevelName(int level){
+    switch (level){
+        case KERNEL_SSE42: return "sse4.2";
+        case KERNEL_AVX2: return "avx2";
+        case KERNEL_AVX512: return "avx512";
+        default: return "scalar";
+    }
+}
+
+int SortedIntersect(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out){
+    if (na == 0 || nb == 0) return 0;
+    if ((long)na*GALLOP_RATIO < nb) return GallopIntersect(a,na,b,nb,out);
+    if ((long)nb*GALLOP_RATIO < na) return GallopIntersect(b,nb,a,na,out);
+    return intersectKernels[kernelLevel](a,na,b,nb,out);
+}
+
+int SortedDifference(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out){
+    if (na == 0) return 0;
+    if (nb == 0){
+        copy(a, a+na, out);
+        return na;
+    }
+    if ((long)na*GALLOP_RATIO < nb) return GallopDifferenceSmallA(a,na,b,nb,out);
+    if ((long)nb*GALLOP_RATIO < na) return GallopDifferenceSmallB(a,na,b,nb,out);
+    return differenceKernels[kernelLevel](a,na,b,nb,out);
+}
+
+int SortedIntersectCount(const unsigned int *a, int na, const unsigned int *b, int nb){
+    if (na == 0 || nb == 0) return 0;
+    if ((long)na*GALLOP_RATIO < nb) return GallopIntersectCount(a,na,b,nb);
+    if ((long)nb*GALLOP_RATIO < na) return GallopIntersectCount(b,nb,a,na);
+    return intersectCountKernels[kernelLevel](a,na,b,nb);
+}
+
+int SortedUnion(const unsigned int *a, int na, const unsigned int *b, int nb, unsigned int *out){
+    return ScalarUnion(a,na,b,nb,out);
+}
+
+int BitAndCount(const unsigned long long *a, const unsigned long long *b, int nwords){
+    return bitAndCountKernels[kernelLevel](a,b,nwords);
+}
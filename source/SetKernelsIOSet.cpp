@@ -0,0 +1,117 @@
+#include "../headers/SetKernels.h"
+#include <atomic>
+
+//the IOSet versions of SetKernels.h, kept apart from SetKernels.cpp so that the kernels
+//themselves link without the core library (drivers/kernel_check.cpp)
+
+typedef int (*SetKernel)(const unsigned int *, int, const unsigned int *, int, unsigned int *);
+
+//! operations counted, see CollectOpCounts()
+enum { OP_INTERSECT, OP_UNION, OP_DIFFERENCE, NUM_OPS };
+//! operations of the threads that have ended
+static atomic<long> endedOps[NUM_OPS];
+
+//! operations of one thread, handed over to endedOps when the thread ends
+struct ThreadOps {
+    long ops[NUM_OPS];
+    ThreadOps(){ fill(ops,ops+NUM_OPS,0); }
+    ~ThreadOps(){
+        for(int i=0; i < NUM_OPS; i++) endedOps[i] += ops[i];
+    }
+};
+static thread_local ThreadOps threadOps;
+
+//! counts one operation of the calling thread
+static inline void CountOp(int op){
+    threadOps.ops[op]++;
+}
+
+void CollectOpCounts(){
+    numIntersection += endedOps[OP_INTERSECT].exchange(0) + threadOps.ops[OP_INTERSECT];
+    numUnion += endedOps[OP_UNION].exchange(0) + threadOps.ops[OP_UNION];
+    numDifference += endedOps[OP_DIFFERENCE].exchange(0) + threadOps.ops[OP_DIFFERENCE];
+    fill(threadOps.ops,threadOps.ops+NUM_OPS,0);
+}
+
+//! pointer to the elements of an IOSet, NULL if it is empty
+static inline unsigned int *Data(IOSet *a){
+    return a->Size() > 0 ? &(*a->GetBegin()) : NULL;
+}
+
+IOSet *IntersectFast(IOSet *a, IOSet *b){
+    CountOp(OP_INTERSECT);
+    IOSet *ret = new IOSet;
+    ret->Resize(min(a->Size(),b->Size()) + KERNEL_SLACK);
+    int k = SortedIntersect(Data(a), a->Size(), Data(b), b->Size(), &(*ret->GetBegin()));
+    ret->Resize(k);
+    return ret;
+}
+
+int IntersectCount(IOSet *a, IOSet *b){
+    return SortedIntersectCount(Data(a), a->Size(), Data(b), b->Size());
+}
+
+///////////////////////////////output parameter versions////////////////////////
+
+//! per thread buffer used when the output of an operation is also one of its inputs
+static thread_local vector<unsigned int> aliasBuffer;
+static thread_local IOSet scratchSets[NUM_SCRATCH];
+
+//! runs kernel on a and b and assigns the result to out, cap is an upper bound on the result size
+static void AssignResult(IOSet *a, IOSet *b, IOSet *out, int cap, SetKernel kernel){
+    if (out != a && out != b){
+        out->Resize(cap + KERNEL_SLACK);
+        int k = kernel(Data(a), a->Size(), Data(b), b->Size(), &(*out->GetBegin()));
+        out->Resize(k);
+    }else{
+        if (aliasBuffer.size() < cap + KERNEL_SLACK) aliasBuffer.resize(cap + KERNEL_SLACK);
+        int k = kernel(Data(a), a->Size(), Data(b), b->Size(), &aliasBuffer[0]);
+        out->Resize(k);
+        if (k > 0) copy(aliasBuffer.begin(), aliasBuffer.begin()+k, out->GetBegin());
+    }
+}
+
+void Intersect(IOSet *a, IOSet *b, IOSet *out){
+    CountOp(OP_INTERSECT);
+    AssignResult(a,b,out,min(a->Size(),b->Size()),SortedIntersect);
+}
+
+void Difference(IOSet *a, IOSet *b, IOSet *out){
+    CountOp(OP_DIFFERENCE);
+    AssignResult(a,b,out,a->Size(),SortedDifference);
+}
+
+void Union(IOSet *a, IOSet *b, IOSet *out){
+    CountOp(OP_UNION);
+    AssignResult(a,b,out,a->Size()+b->Size(),SortedUnion);
+}
+
+void DifferenceInPlace(IOSet *a, IOSet *b){
+    Difference(a,b,a);
+}
+
+void UnionInPlace(IOSet *a, IOSet *b){
+    Union(a,b,a);
+}
+
+IOSet *PrimeFast(NCluster *a, RelationGraph *g, int s, int t, int min){
+    IOSet *as = a->GetSetById(s);
+    if (as->Size() == 0)
+        return NULL;
+    Context *c = g->GetContext(s,t);
+    IOSet *ret = new IOSet(c->GetSet(s,as->At(0)));
+    //the result only shrinks, stop as soon as it is too small
+    for(int i=1; i < as->Size() && ret->Size() >= min; i++)
+        Intersect(ret,c->GetSet(s,as->At(i)),ret);
+    if (ret->Size() < min){
+        delete ret;
+        return NULL;
+    }
+    ret->SetId(t);
+    return ret;
+}
+
+IOSet *ScratchSet(int slot){
+    assert(slot >= 0 && slot < NUM_SCRATCH);
+    return &scratchSets[slot];
+}
@@ -0,0 +1,104 @@
+#include "../headers/TopKOverlap.h"
+
+//deletes c, or hands it to dropped if given
+static void Drop(NCluster *c, vector<NCluster*> *dropped){
+    if (dropped != NULL)
+        dropped->push_back(c);
+    else
+        delete c;
+}
+
+QualityHeap::QualityHeap(){
+    nextSerial = 0;
+}
+
+void QualityHeap::Insert(NCluster *c, int i){
+    Entry e;
+    e.quality = c->GetQuality();
+    e.serial = nextSerial++;
+    e.c = c;
+    live[c] = make_pair(e.serial,i);
+    heap.push_back(e);
+    push_heap(heap.begin(),heap.end(),Above);
+}
+
+void QualityHeap::Remove(NCluster *c){
+    live.erase(c);
+    if (heap.size() > 2*live.size() + 16)
+        Rebuild();
+}
+
+void QualityHeap::Move(NCluster *c, int i){
+    live[c].second = i;
+}
+
+int QualityHeap::Worst(){
+    while (!heap.empty()){
+        unordered_map<NCluster*, pair<long,int> >::iterator it = live.find(heap.front().c);
+        if (it != live.end() && it->second.first == heap.front().serial)
+            return it->second.second;
+        pop_heap(heap.begin(),heap.end(),Above);
+        heap.pop_back();
+    }
+    return -1;
+}
+
+void QualityHeap::Rebuild(){
+    heap.clear();
+    for(unordered_map<NCluster*, pair<long,int> >::iterator it = live.begin(); it != live.end(); ++it){
+        Entry e;
+        e.quality = it->first->GetQuality();
+        e.serial = it->second.first;
+        e.c = it->first;
+        heap.push_back(e);
+    }
+    make_heap(heap.begin(),heap.end(),Above);
+}
+
+//drops v[i] and moves the last cluster of v into its place
+static void RemoveAt(vector<NCluster*> &v, OverlapIndex &index, QualityHeap &heap, int i, vector<NCluster*> *dropped){
+    heap.Remove(v[i]);
+    Drop(v[i],dropped);
+    index.Remove(i);
+    int last = v.size()-1;
+    if (i != last){
+        v[i] = v[last];
+        index.Move(last,i);
+        heap.Move(v[i],i);
+    }
+    v.pop_back();
+}
+
+bool RetainTopK_OverlapIndexed(vector<NCluster*> &v, NCluster *c,double (*Ovlp)(NCluster*,NCluster*), OverlapIndex &index, QualityHeap &heap, int k, vector<NCluster*> *dropped){
+    vector<int> cands;
+    index.Candidates(c,cands);
+    vector<int> overlapping;
+    for(int i=0; i < cands.size(); i++){
+        if (Ovlp(c,v[cands[i]]) > index.GetThreshold()){
+            if (c->GetQuality() <= v[cands[i]]->GetQuality()){
+                Drop(c,dropped);
+                return false;
+            }
+            overlapping.push_back(cands[i]);
+        }
+    }
+    if (overlapping.empty() && v.size() >= k){
+        if (k <= 0){
+            Drop(c,dropped);
+            return false;
+        }
+        int worst = heap.Worst();
+        if (c->GetQuality() <= v[worst]->GetQuality()){
+            Drop(c,dropped);
+            return false;
+        }
+        overlapping.push_back(worst);
+    }
+    //from the back, so that no cluster still to be removed is moved
+    for(int i=overlapping.size()-1; i >= 0; i--)
+        RemoveAt(v,index,heap,overlapping[i],dropped);
+    v.push_back(c);
+    index.Insert(v.size()-1,c);
+    heap.Insert(c,v.size()-1);
+    return true;
+}
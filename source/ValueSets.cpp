@@ -0,0 +1,157 @@
+#include "../headers/ValueSets.h"
+#include "../headers/SetKernels.h"
+#include <cstring>
+
+/////////////////////////////SmallSet///////////////////////////////////////////
+
+SmallSet::SmallSet(){
+    d = local;
+    size = 0;
+    capacity = INLINE_CAPACITY;
+}
+
+SmallSet::SmallSet(const SmallSet &a){
+    d = local;
+    size = 0;
+    capacity = INLINE_CAPACITY;
+    Append(a.d,a.size);
+}
+
+SmallSet::SmallSet(SmallSet &&a){
+    size = a.size;
+    if (a.IsInline()){
+        d = local;
+        capacity = INLINE_CAPACITY;
+        memcpy(local,a.local,size*sizeof(unsigned int));
+    }else{
+        //take over the heap block
+        d = a.d;
+        capacity = a.capacity;
+        a.d = a.local;
+        a.capacity = INLINE_CAPACITY;
+    }
+    a.size = 0;
+}
+
+SmallSet &SmallSet::operator=(const SmallSet &a){
+    if (this != &a){
+        size = 0;
+        Append(a.d,a.size);
+    }
+    return *this;
+}
+
+SmallSet &SmallSet::operator=(SmallSet &&a){
+    if (this == &a)
+        return *this;
+    if (a.IsInline()){
+        //keep our own block, just copy the few inline elements
+        size = 0;
+        Append(a.local,a.size);
+    }else{
+        if (!IsInline())
+            delete [] d;
+        d = a.d;
+        size = a.size;
+        capacity = a.capacity;
+        a.d = a.local;
+        a.capacity = INLINE_CAPACITY;
+    }
+    a.size = 0;
+    return *this;
+}
+
+SmallSet::~SmallSet(){
+    if (!IsInline())
+        delete [] d;
+}
+
+void SmallSet::Reserve(int n){
+    if (n <= capacity)
+        return;
+    int newCap = capacity*2 > n ? capacity*2 : n;
+    unsigned int *block = new unsigned int[newCap];
+    memcpy(block,d,size*sizeof(unsigned int));
+    if (!IsInline())
+        delete [] d;
+    d = block;
+    capacity = newCap;
+}
+
+void SmallSet::Add(unsigned int x){
+    if (size == capacity)
+        Reserve(size+1);
+    d[size++] = x;
+}
+
+void SmallSet::Append(const unsigned int *v, int n){
+    Reserve(size+n);
+    memcpy(d+size,v,n*sizeof(unsigned int));
+    size += n;
+}
+
+void SmallSet::Clear(){
+    size = 0;
+}
+
+void SmallSet::Resize(int n){
+    Reserve(n);
+    size = n;
+}
+
+/////////////////////////////FlatCluster////////////////////////////////////////
+
+FlatCluster::FlatCluster(){
+    offsets.Add(0);
+    quality = 0;
+}
+
+FlatCluster::FlatCluster(NCluster *a){
+    offsets.Add(0);
+    quality = 0;
+    Assign(a);
+}
+
+void FlatCluster::AddSet(IOSet *a){
+    int strt = data.Size();
+    data.Resize(strt+a->Size());
+    for(int i=0; i < a->Size(); i++) data[strt+i] = a->At(i);
+    offsets.Add(data.Size());
+    ids.Add(a->Id());
+}
+
+void FlatCluster::Assign(NCluster *a){
+    Clear();
+    int total=0;
+    for(int i=0; i < a->GetN(); i++) total += a->GetSet(i)->Size();
+    //one allocation at most for the whole cluster
+    data.Reserve(total);
+    for(int i=0; i < a->GetN(); i++) AddSet(a->GetSet(i));
+    quality = a->GetQuality();
+}
+
+void FlatCluster::Clear(){
+    data.Clear();
+    offsets.Clear();
+    offsets.Add(0);
+    ids.Clear();
+    quality = 0;
+}
+
+int FlatCluster::IntersectCount(int i, IOSet *b) const{
+    if (b->Size() == 0)
+        return 0;
+    return SortedIntersectCount(GetSetData(i),GetSetSize(i),&(*b->GetBegin()),b->Size());
+}
+
+NCluster *FlatCluster::ToNCluster() const{
+    NCluster *ret = new NCluster(GetN());
+    for(int i=0; i < GetN(); i++){
+        IOSet *curr = ret->GetSet(i);
+        const unsigned int *v = GetSetData(i);
+        for(int j=0; j < GetSetSize(i); j++) curr->Add(v[j]);
+        curr->SetId(GetSetId(i));
+    }
+    ret->SetQuality(quality);
+    return ret;
+}
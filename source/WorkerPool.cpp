@@ -0,0 +1,67 @@
+#include "../headers/WorkerPool.h"
+
+WorkerPool::WorkerPool(int numThreads){
+    generation = 0;
+    stop = false;
+    active = 0;
+    body = NULL;
+    numChunks = 0;
+    next = 0;
+    busy = false;
+    for(int i=1; i < numThreads; i++)
+        helpers.push_back(thread(&WorkerPool::Help,this));
+}
+
+WorkerPool::~WorkerPool(){
+    {
+        lock_guard<mutex> guard(lock);
+        stop = true;
+    }
+    wake.notify_all();
+    for(int i=0; i < helpers.size(); i++)
+        helpers[i].join();
+}
+
+void WorkerPool::Work(){
+    for(int c = next.fetch_add(1); c < numChunks; c = next.fetch_add(1))
+        (*body)(c);
+}
+
+void WorkerPool::Help(){
+    long seen = 0;
+    unique_lock<mutex> guard(lock);
+    while (true){
+        while (!stop && generation == seen)
+            wake.wait(guard);
+        if (stop)
+            return;
+        seen = generation;
+        guard.unlock();
+        Work();
+        guard.lock();
+        if (--active == 0)
+            done.notify_one();
+    }
+}
+
+void WorkerPool::Run(int numChunks, const function<void(int)> &body){
+    bool idle = false;
+    if (helpers.empty() || numChunks < 2 || !busy.compare_exchange_strong(idle,true)){
+        //nothing to share, or another loop is using the helpers
+        for(int c=0; c < numChunks; c++) body(c);
+        return;
+    }
+    unique_lock<mutex> guard(lock);
+    this->body = &body;
+    this->numChunks = numChunks;
+    next = 0;
+    active = helpers.size();
+    generation++;
+    guard.unlock();
+    wake.notify_all();
+    Work();
+    guard.lock();
+    while (active > 0)
+        done.wait(guard);
+    busy = false;
+}
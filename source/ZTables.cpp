@@ -0,0 +1,57 @@
+#include "../headers/ZTables.h"
+
+ZTable::ZTable(){
+    kind = -1;
+    n = -1;
+    NN = -1;
+    zeroZ = 0;
+}
+
+void ZTable::Build(int kind, int n, int NN, const vector<int> &degrees){
+    if (kind == this->kind && n == this->n && NN == this->NN)
+        return;
+    this->kind = kind;
+    this->n = n;
+    this->NN = NN;
+    int maxDeg = degrees.empty() ? 0 : degrees.back();
+    mean.resize(maxDeg+1);
+    dev.resize(maxDeg+1);
+    for(int i=0; i < degrees.size(); i++){
+        int m = degrees[i];
+        if (kind == HYPGEO){
+            mean[m] = Hypgeo_Mean(n,m,NN);
+            dev[m] = Hypgeo_Dev(n,m,NN);
+        }else{
+            int alpha = m+1;
+            int beta = NN-m+1;
+            mean[m] = BetaBinomial_Mean(n,alpha,beta);
+            dev[m] = BetaBinomial_Dev(n,alpha,beta);
+        }
+    }
+    zeroZ = -HUGE_VAL;
+    for(int i=0; i < degrees.size(); i++)
+        zeroZ = max(zeroZ,Z(0,degrees[i]));
+}
+
+void ZTable::Accumulate(const int *ones, const int *degrees, int count, double w, double *scores) const{
+    const double *mn = mean.data();
+    const double *dv = dev.data();
+    for(int i=0; i < count; i++){
+        int m = degrees[i];
+        double x = ones[i];
+        //a zero deviation is left to Z_Score, everything else is the plain z-score
+        double z = dv[m] != 0 ? (x - mn[m]) / dv[m] : Z_Score(x,mn[m],dv[m]);
+        scores[i] += z - w;
+    }
+}
+
+void ZTable::AccumulateBound(const int *degrees, int count, double w, double *bounds) const{
+    const double *mn = mean.data();
+    const double *dv = dev.data();
+    for(int i=0; i < count; i++){
+        int m = degrees[i];
+        //an object cannot share more than min(m,n) objects with the cluster set
+        double x = m < n ? m : n;
+        bounds[i] += dv[m] != 0 ? (x - mn[m]) / dv[m] - w : HUGE_VAL;
+    }
+}
@@ -1,18 +1,34 @@
 #include "../headers/random_sample.h"
 
+//log2 of a weight of 0
+static const long double LOG2_ZERO = -INFINITY;
 
+//turns the log2 weights in w into weights that sum to 1, returns false if all weights are 0
+static bool NormalizeLog2Weights(vector<long double> &w){
+    //the weights are powers of 2 of object degrees and overflow even a long double on
+    //hubs, so the largest one is factored out before exponentiating (log-sum-exp)
+    long double top = LOG2_ZERO;
+    for(int i=0; i < w.size(); i++) top = max(top,w[i]);
+    if (top == LOG2_ZERO)
+        return false;
+    long double sum = 0;
+    for(int i=0; i < w.size(); i++){
+        w[i] = w[i] == LOG2_ZERO ? 0 : exp2l(w[i]-top);
+        sum += w[i];
+    }
+    for(int i=0; i < w.size(); i++) w[i] /= sum;
+    return true;
+}
 
 
 vector<long double> * NClusterRandomSample::GetFreqWeights(Context *c, int s, int t){
     vector<long double> *weights = new vector<long double>(c->GetNumSets(t));
-    long double sum = 0;
     for (int i=0; i < c->GetNumSets(t); i++){
         long double pwr=(long double)c->GetSet(t,i)->Size();///10.0;
        // cout<<"\nweights i "<<i<<" as "<<c->GetSet(t,i)->Size();
-        (*weights)[i] = pow(2,pwr); // weigh by size of power set
-        sum += (*weights)[i];
+        (*weights)[i] = pwr; // weigh by size of power set, 2^pwr
     }
-    for(int i=0; i < weights->size(); i++) (*weights)[i] /= sum;
+    NormalizeLog2Weights(*weights);
     return weights;
 }
 
@@ -20,7 +36,6 @@ vector<long double> * NClusterRandomSample::GetFreqWeightsStar(RelationGraph *g,
     IOSet *sObjs = g->GetLabels(s);
     vector<long double> *weights = new vector<long double>(sObjs->Size());
     vector<Context*> *ctxs = g->GetContexts(s);
-    long double sum=0.0;
     for(int i=0; i < sObjs->Size(); i++){
         long double avgTlength=0;
         for(int j=0; j < ctxs->size(); j++){
@@ -31,36 +46,32 @@ vector<long double> * NClusterRandomSample::GetFreqWeightsStar(RelationGraph *g,
 				avgTlength = 0;
 				break;
 			}else{
-				avgTlength += avgTlength;
+				avgTlength += currTLength;
 			}
         }
 		avgTlength /= (long double) ctxs->size();
-		(*weights)[i] = pow(2,avgTlength);
-                sum += (*weights)[i];
+		(*weights)[i] = avgTlength; //2^avgTlength
 		
     }
     delete sObjs;
-    for(int i=0; i < weights->size(); i++) (*weights)[i] /= sum;
+    NormalizeLog2Weights(*weights);
     return weights;
 }
 
 vector<long double> * NClusterRandomSample::GetFreqWeightsStar(RelationGraph *g, int s, NCluster *subSets){
     IOSet *sObjs = g->GetLabels(s);
     vector<long double> *weights = new vector<long double>(sObjs->Size());
-    fill(weights->begin(),weights->end(),0.0);
+    fill(weights->begin(),weights->end(),LOG2_ZERO);
     IOSet *tmp = sObjs;
-    sObjs = Intersect(sObjs,subSets->GetSetById(s));
+    sObjs = IntersectFast(sObjs,subSets->GetSetById(s));
     delete tmp;
     vector<Context*> *ctxs = g->GetContexts(s);
-    long double sum=0.0;
     for(int i=0; i < sObjs->Size(); i++){
         long double avgTlength=0;
         for(int j=0; j < ctxs->size(); j++){
             pair<int,int> dIds = (*ctxs)[j]->GetDomainIds();
 			int t= dIds.first == s ? dIds.second: dIds.first;
-                        IOSet *tt =  Intersect( (*ctxs)[j]->GetSet(s,sObjs->At(i)),subSets->GetSetById(t));
-
-			long double currTLength = tt->Size();
+			long double currTLength = IntersectCount( (*ctxs)[j]->GetSet(s,sObjs->At(i)),subSets->GetSetById(t));
                         //cout<<"\ncurr length "<<currTLength;
 			if (currTLength == 0){
 				avgTlength = 0;
@@ -68,40 +79,33 @@ vector<long double> * NClusterRandomSample::GetFreqWeightsStar(RelationGraph *g,
 			}else{
 				avgTlength += currTLength;
 			}
-                        delete tt;
         }
        // cout<<"\navgT "<<avgTlength;
                 avgTlength /= (long double) ctxs->size();
+                //log2 of the weight 2^avgTlength
                 if(avgTlength == 0)
-                    (*weights)[sObjs->At(i)] = (long double)0.0;
+                    (*weights)[sObjs->At(i)] = LOG2_ZERO;
                 else
-                    (*weights)[sObjs->At(i)] = (long double)pow((long double)2.0,avgTlength);
+                    (*weights)[sObjs->At(i)] = avgTlength;
                // cout<<"\nadding weight "<<(*weights)[sObjs->At(i)]<<" at loc: "<<sObjs->At(i);
-                sum += (*weights)[sObjs->At(i)];
 
     }
 
     delete sObjs;
-    if (sum == 0){
-      // DstryVector(weights);
+    if (!NormalizeLog2Weights(*weights)){
+        delete weights;
         return NULL;
     }
-    for(int i=0; i < weights->size(); i++){
-       
-        (*weights)[i] /= sum;
-         //cout<<"\nweights ("<<i<<"): "<<(*weights)[i];
-    }
     return weights;
 }
 vector<long double> * NClusterRandomSample::GetAreaWeights(Context *c, int s, int t){
     vector< long double> *weights = new vector<long double>(c->GetNumSets(t));
-    long double sum=0;
     for (int i=0; i < c->GetNumSets(t); i++){
-        double pwr=(long double)c->GetSet(t,i)->Size();///10.0;
-        (*weights)[i] = pwr*pow(2,pwr-1); // weigh by size of power set
-        sum += (*weights)[i];
+        long double pwr=(long double)c->GetSet(t,i)->Size();///10.0;
+        // weigh by size of power set, pwr*2^(pwr-1)
+        (*weights)[i] = pwr == 0 ? LOG2_ZERO : log2l(pwr)+pwr-1;
     }
-    for(int i=0; i < weights->size(); i++) (*weights)[i] /= sum;
+    NormalizeLog2Weights(*weights);
 
     return weights;
 }
@@ -110,24 +114,27 @@ IOSet* NClusterRandomSample::SubspaceFreq(Context *c, int s,int t, vector<long d
     //randomly draw object from t
     cout<<"\nweights size: "<<weights.size();
     int randT;
+    //redrawn until a non-empty set is hit, so the table is built once
+    AliasTable table;
+    table.Build(weights);
     do{
-        randT =  WeightedUniformDraw(weights);
+        randT =  DrawAlias(table);
     }while(c->GetSet(t,randT)->Size() == 0);
    cout<<"\ntransaction selected: "<<randT;
    cout<<"\ntransact had weight "<<weights[randT];
     //uniformly select from power set of psi^t(randT)
     cout<<"\t size: "<<c->GetSet(t,randT)->Size();
     cout.flush();
-    IOSet *ret = UniformSubsetDraw(c->GetSet(t,randT));
+    IOSet *ret = DrawUniformSubset(c->GetSet(t,randT));
     ret->SetId(s);
     return ret;
 
 }
 IOSet* NClusterRandomSample::SubspaceArea(Context *c, int s, int t, vector<long double> &weights){
-    int randT =  WeightedUniformDraw(weights);
+    int randT =  DrawWeighted(weights);
     //cout<<"\ntransaction selected: "<<randT;
     //uniformly select from power set of psi^t(randT)
-    IOSet *ret =  BinomialSubsetDraw(c->GetSet(t,randT));
+    IOSet *ret =  DrawBinomialSubset(c->GetSet(t,randT));
     ret->SetId(s);
     return ret;
 }
@@ -137,13 +144,14 @@ IOSet* NClusterRandomSample::SubspaceArea(Context *c, int s, int t, vector<long
 NCluster* NClusterRandomSample::SubspaceStarShapedFreqSample(RelationGraph *g, int s, NCluster *sample, IOSet *completedDomains ){
     vector<Context*> *ctxs = g->GetContexts(s);
     //assign weights to s-objects based on average frequence in all domains
-    vector<long double> *sWeights = GetFreqWeightsStar(g,s, sample);
+    //sample is the subspace passed to SubspaceFreqNetwork until a domain is completed
+    AliasTable *sWeights = FreqTableStar(g,s,sample,completedDomains->Size() == 0);
     if (sWeights == NULL)
         return NULL;
     //draw an object in s ~ sWeights
     int randS;
-   // cout<<"\nsWeights size: "<<sWeights->size();
-    randS = WeightedUniformDraw(*sWeights);
+   // cout<<"\nsWeights size: "<<sWeights->Size();
+    randS = DrawAlias(*sWeights);
   //  cout<<"\nrandomly drew "<<randS<<" as S object...with weight: "<<(*sWeights)[randS]<<"\nGetting primes...\n";
    // cout.flush();
     //now do primes
@@ -155,44 +163,36 @@ NCluster* NClusterRandomSample::SubspaceStarShapedFreqSample(RelationGraph *g, i
               int t = ctxIds.first == s ? ctxIds.second : ctxIds.first;
               if(!completedDomains->Contains(t)) { //only perform operation in context not already sampled
                //   cout<<"\nprimeing and intersectiong in context "<<t<<"_"<<s;
-                  IOSet *currT = currContext->GetSet(s,randS);
-                //  cout<<"\nbefore intersect: "; currT->Output();
-                  currT = Intersect(currT,sample->GetSetById(t));
+                  IOSet *currT = ScratchSet(1);
+                //  cout<<"\nbefore intersect: "; currContext->GetSet(s,randS)->Output();
+                  Intersect(currContext->GetSet(s,randS),sample->GetSetById(t),currT);
          
                   //cout<<endl; cout<<"\nafter the intersectt...the curr T: ";currT->Output();
-                  IOSet *tt= UniformSubsetDraw(currT);
+                  IOSet *tt= DrawUniformSubset(currT);
                   tt->SetId(t);
                   ret->AddSet(tt);
                   //now prime into s and take intersection
-                  IOSet *sPrime = Prime(ret,g,t,s,1);
+                  IOSet *sPrime = PrimeFast(ret,g,t,s,1);
                   if(sPrime == NULL){
                       delete ret;
                       delete ss;
-                      delete currT;
-                      delete sWeights;
                       return NULL;
                   }
-                  IOSet *tmp = sPrime;
                   //intersect to get subset
                  // cout<<"\nsprime: "; sPrime->Output();
                  // cout.flush();
-                  sPrime = Intersect(sPrime,sample->GetSetById(s));
-                   delete tmp;
+                  Intersect(sPrime,sample->GetSetById(s),sPrime);
                   //now intersection with other s Sets
                    if(ss->Size() > 0){
-                       tmp =ss;
-                       ss=Intersect(ss,sPrime);
-                       delete tmp;
+                       Intersect(ss,sPrime,ss);
                    }else{
                        ss->DeepCopy(sPrime);
                    }
                    delete sPrime;
-                   delete currT;
               }
          }
     ss->SetId(s);
     ret->AddSet(ss);
-    delete sWeights;
     return ret;
     }
 
@@ -201,20 +201,13 @@ NCluster * NClusterRandomSample::SubspaceFreqNetwork(RelationGraph *g, int s,NCl
     //first step is to generate n-cluster in initial star shaped hin
     //as defined by s
     IOSet *completedDomains = new IOSet; // keep tracking of the domains that have already been completed
-    //construct the sample subspace
-    NCluster *sampleSubspace = new NCluster(*subspace);
-     NCluster *init1 = SubspaceStarShapedFreqSample(g,s,sampleSubspace,completedDomains);
+    //the first star only reads the subspace
+     NCluster *init1 = SubspaceStarShapedFreqSample(g,s,subspace,completedDomains);
    //  cout<<"\ngot init1...\n";
      if (init1 == NULL){
          delete completedDomains;
-         delete sampleSubspace;
          return NULL;
      }
-     NCluster *ret = new NCluster;
-     AdjustSampleSubspace(sampleSubspace,init1,ret,completedDomains);
-     delete init1;
-     //cout<<"\nsample subspace: \n";
-     //sampleSubspace->Output();
     //do a BFS using SubspaceStarShapedFreqSample
     //insert all neighboring articulation nodes of s
     IOSet *artDomains = g->GetArtDomains();
@@ -228,6 +221,15 @@ NCluster * NClusterRandomSample::SubspaceFreqNetwork(RelationGraph *g, int s,NCl
     }
   // cout<<"\nq size: "<<q.size();
     delete sNeighbors;
+    //construct the sample subspace, only needed if the BFS goes on
+    NCluster *sampleSubspace = NULL;
+    if (!q.empty())
+        sampleSubspace = pool != NULL ? pool->CopyCluster(subspace) : new NCluster(*subspace);
+     NCluster *ret = new NCluster;
+     AdjustSampleSubspace(sampleSubspace,init1,ret,completedDomains);
+     delete init1;
+     //cout<<"\nsample subspace: \n";
+     //sampleSubspace->Output();
     while (!q.empty()){
         int s1 = q.front();
         q.pop();
@@ -236,7 +238,7 @@ NCluster * NClusterRandomSample::SubspaceFreqNetwork(RelationGraph *g, int s,NCl
            // cout<<"\ninit 1 was null (q)";
             delete ret;
             delete completedDomains;
-            delete sampleSubspace;
+            if (pool == NULL) delete sampleSubspace;
             return NULL;
         }
      //   cout<<"\ngot init1: \n"; init1->Output();
@@ -251,7 +253,7 @@ NCluster * NClusterRandomSample::SubspaceFreqNetwork(RelationGraph *g, int s,NCl
         delete sNeighbors;
     }
     delete completedDomains;
-    delete sampleSubspace;
+    if (pool == NULL) delete sampleSubspace;
     return ret;
 }
 
@@ -261,7 +263,44 @@ void NClusterRandomSample::AdjustSampleSubspace(NCluster *sampleSubspace, NClust
         IOSet *tt = new IOSet(sample->GetSetById(currId));
         ret->AddSet(tt);
         completedDomains->Add(currId);
+        if (sampleSubspace == NULL)
+            continue;
         IOSet *currSample =sampleSubspace->GetSetById(currId);
         currSample->DeepCopy(sample->GetSetById(currId));
     }
 }
+
+int NClusterRandomSample::DrawWeighted(vector<long double> &weights){
+    return rng != NULL ? WeightedUniformDraw(*rng,weights) : WeightedUniformDraw(weights);
+}
+
+IOSet *NClusterRandomSample::DrawUniformSubset(IOSet *t){
+    return rng != NULL ? UniformSubsetDraw(*rng,t) : UniformSubsetDraw(t);
+}
+
+IOSet *NClusterRandomSample::DrawBinomialSubset(IOSet *t){
+    return rng != NULL ? BinomialSubsetDraw(*rng,t) : BinomialSubsetDraw(t);
+}
+
+int NClusterRandomSample::DrawAlias(const AliasTable &table){
+    return rng != NULL ? table.Draw(*rng) : table.Draw(rand()/((double)RAND_MAX+1));
+}
+
+AliasTable *NClusterRandomSample::FreqTableStar(RelationGraph *g, int s, NCluster *sample, bool cached){
+    AliasTable *table = &localTable;
+    if (tables != NULL && cached){
+        //the weights only depend on the sets of sample, a table computed from the same version is reused
+        table = tables->Find(s,version);
+        if (table != NULL)
+            return table->Size() > 0 ? table : NULL;
+        table = tables->Store(s,version);
+    }
+    vector<long double> *weights = GetFreqWeightsStar(g,s,sample);
+    if (weights == NULL){
+        table->Build(vector<long double>());
+        return NULL;
+    }
+    table->Build(*weights);
+    delete weights;
+    return table;
+}